@@ -0,0 +1,168 @@
+/******************************************************************************/
+/*  bench_gamma.cpp                                                           */
+/*        scaling of final state search in GAMFinalState, make bench_gamma    */
+/******************************************************************************/
+
+#include <sstream>
+#include <chrono>
+#include <cstdio>
+#include <unistd.h>
+
+#define CENS_TOPLEVEL
+std::ostringstream message;
+
+/* search functions are static in censgamma.cpp */
+#include "censgamma.cpp"
+
+static void   BENCHLevelScheme(ENSDF *, const int, const int);
+static double BENCHRandom(void);
+static double BENCHTime(void);
+
+static unsigned long long benchseed = 88172645463325252ULL;
+
+
+/**********************************************************/
+/*      Main                                              */
+/**********************************************************/
+int main(int argc, char *argv[])
+{
+  int ngamma = 4, repeat = 3;
+
+  int p;
+  while((p = getopt(argc,argv,"g:r:h")) != -1){
+    switch(p){
+    case 'g': ngamma = atoi(optarg); break;
+    case 'r': repeat = atoi(optarg); break;
+    default:
+      cout << "bench_gamma [-g gammas per level] [-r repeat]" << endl;
+      return 0;
+    }
+  }
+  if(repeat < 1) repeat = 1;
+  if(ngamma < 1) ngamma = 1;
+
+  const int nscheme = 5;
+  int nlevel[nscheme] = {100, 300, 1000, 3000, MaxDiscreteLevels - 1};
+
+  ENSDF lib;
+  lib.memalloc(MaxDiscreteLevels,ngamma + 2);
+  lib.setUnit("MeV");
+
+  cout << "# final state search, " << ngamma << " gammas/level, best of " << repeat << endl;
+  cout << "#  levels     gammas   linear[s]   binary[s]    speedup  mismatch" << endl;
+
+  for(int n=0 ; n<nscheme ; n++){
+    lib.clear();
+    BENCHLevelScheme(&lib,nlevel[n],ngamma);
+
+    long ng = 0;
+    for(int i=1 ; i<lib.getNlevel() ; i++) ng += lib.gamma[i].getNgamma();
+
+    /* linear scan, as done before */
+    double t1 = 0.0;
+    long   s1 = 0;
+    for(int r=0 ; r<repeat ; r++){
+      double t0 = BENCHTime();
+      for(int i=1 ; i<lib.getNlevel() ; i++){
+        for(int j=0 ; j<lib.gamma[i].getNgamma() ; j++) s1 += GAMFinalLevelLinear(&lib,i,lib.gamma[i].energy[j]);
+      }
+      double t = BENCHTime() - t0;
+      if((r == 0) || (t < t1)) t1 = t;
+    }
+
+    /* binary search */
+    double t2 = 0.0;
+    long   s2 = 0;
+    for(int r=0 ; r<repeat ; r++){
+      double t0 = BENCHTime();
+      for(int i=1 ; i<lib.getNlevel() ; i++){
+        for(int j=0 ; j<lib.gamma[i].getNgamma() ; j++) s2 += GAMFinalLevelSearch(&lib,i,lib.gamma[i].energy[j]);
+      }
+      double t = BENCHTime() - t0;
+      if((r == 0) || (t < t2)) t2 = t;
+    }
+
+    /* both must give the same final level */
+    long nm = 0;
+    for(int i=1 ; i<lib.getNlevel() ; i++){
+      for(int j=0 ; j<lib.gamma[i].getNgamma() ; j++){
+        double eg = lib.gamma[i].energy[j];
+        if(GAMFinalLevelLinear(&lib,i,eg) != GAMFinalLevelSearch(&lib,i,eg)) nm++;
+      }
+    }
+    if(s1 != s2) nm++;
+
+    printf("  %7d %10ld %11.4e %11.4e %10.1f %9ld\n",lib.getNlevel(),ng,t1,t2,t1/((t2 > 0.0) ? t2 : 1e-9),nm);
+  }
+
+  return 0;
+}
+
+
+/**********************************************************/
+/*      Synthetic Level Scheme                            */
+/**********************************************************/
+/* level spacing shrinks with excitation energy, some levels are
+   degenerated, and gamma-ray energies deviate from the spacing */
+void BENCHLevelScheme(ENSDF *lib, const int nlevel, const int ngamma)
+{
+  int    js[1] = {0}, ps[1] = {1};
+  double e = 0.0;
+
+  for(int i=0 ; i<nlevel ; i++){
+    lib->setLevel(e,0.0,1,js,ps);
+    if(BENCHRandom() > 0.05) e += 0.001 + 0.2 * BENCHRandom() * 10.0 / (10.0 + i);
+  }
+
+  for(int i=1 ; i<lib->getNlevel() ; i++){
+    int ng = (i < ngamma) ? i : ngamma;
+    for(int g=0 ; g<ng ; g++){
+      int f = (int)(i * BENCHRandom());
+      double eg = lib->energy[i] - lib->energy[f];
+      if(eg <= 0.0) eg = 1e-3;
+      if(BENCHRandom() < 0.5) eg *= 1.0 + 2e-3 * (BENCHRandom() - 0.5);
+      lib->gamma[i].setGamma(eg,1.0,0.0);
+    }
+  }
+}
+
+
+/**********************************************************/
+/*      Uniform Random Number, xorshift                   */
+/**********************************************************/
+double BENCHRandom()
+{
+  benchseed ^= benchseed << 13;
+  benchseed ^= benchseed >> 7;
+  benchseed ^= benchseed << 17;
+  return (double)(benchseed >> 11) / 9007199254740992.0;
+}
+
+
+/**********************************************************/
+/*      Timer                                             */
+/**********************************************************/
+double BENCHTime()
+{
+  return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+/**********************************************************/
+/*      Messages                                          */
+/**********************************************************/
+void WarningMessage()
+{
+  message.str("");
+}
+
+void Notice(string)
+{
+  message.str("");
+}
+
+int TerminateCode(string module)
+{
+  cerr << "ERROR     :[" << module << "] " << message.str() << endl;
+  exit(-1);
+}
@@ -0,0 +1,476 @@
+/******************************************************************************/
+/*  bench_parse.cpp                                                           */
+/*        throughput of ENSDF parser stages, built by make bench_parse        */
+/******************************************************************************/
+
+#include <sstream>
+#include <chrono>
+#include <cstdio>
+#include <unistd.h>
+
+#define CENS_TOPLEVEL
+std::ostringstream message;
+
+/* stage functions are static in ensdfread.cpp */
+#include "ensdfread.cpp"
+
+class BenchParam{
+ public:
+  int    ndataset;  // number of synthetic adopted data sets
+  int    nlevel;    // levels per data set
+  int    ngamma;    // gamma-rays per level
+  double cont;      // continuation records per L and G record
+  double jpimix;    // fraction of uncertain or multiple J-pi
+  int    repeat;    // repeat each stage, best time taken
+  string dir;       // real ENSDF directory
+
+  BenchParam(){
+    ndataset = 20;
+    nlevel   = 1000;
+    ngamma   = 4;
+    cont     = 0.5;
+    jpimix   = 0.3;
+    repeat   = 5;
+    dir      = "";
+  }
+};
+
+static void   BENCHGenerate(BenchParam *, string *);
+static void   BENCHRecord(string *, const char *, const char, const char, const char *);
+static void   BENCHField(char *, const int, const char *);
+static double BENCHRandom(void);
+static int    BENCHCorpus(BenchParam *, string *);
+static void   BENCHRun(const int, string *, const int);
+static double BENCHTime(void);
+static void   BENCHPrint(const char *, const long, const long, const double);
+
+static unsigned long long benchseed = 88172645463325252ULL;
+
+
+/**********************************************************/
+/*      Main                                              */
+/**********************************************************/
+int main(int argc, char *argv[])
+{
+  BenchParam bp;
+
+  int p;
+  while((p = getopt(argc,argv,"n:l:g:c:j:r:d:h")) != -1){
+    switch(p){
+    case 'n': bp.ndataset = atoi(optarg); break;
+    case 'l': bp.nlevel   = atoi(optarg); break;
+    case 'g': bp.ngamma   = atoi(optarg); break;
+    case 'c': bp.cont     = atof(optarg); break;
+    case 'j': bp.jpimix   = atof(optarg); break;
+    case 'r': bp.repeat   = atoi(optarg); break;
+    case 'd': bp.dir      = optarg;       break;
+    default:
+      cout << "bench_parse [-n datasets] [-l levels] [-g gammas] [-c continuation]\n"
+              "            [-j jpi-mix] [-r repeat] [-d ENSDF directory]" << endl;
+      return 0;
+    }
+  }
+  if(bp.repeat < 1) bp.repeat = 1;
+
+  /* synthetic data are written to a file to be read by ENSDFRead */
+  string *file;
+  int nfile = 0;
+  if(bp.dir.length() == 0){
+    string buf;
+    BENCHGenerate(&bp,&buf);
+
+    char tmp[] = "/tmp/bench_parse_XXXXXX";
+    int fd = mkstemp(tmp);
+    if((fd < 0) || (write(fd,buf.c_str(),buf.length()) != (ssize_t)buf.length())){
+      cerr << "temporary file cannot be written" << endl;
+      return -1;
+    }
+    close(fd);
+
+    nfile = 1;
+    file = new string [1];
+    file[0] = tmp;
+
+    cout << "# synthetic: " << bp.ndataset << " data sets, " << bp.nlevel << " levels, ";
+    cout << bp.ngamma << " gammas/level, continuation " << bp.cont << ", J-pi mix " << bp.jpimix << endl;
+  }
+  else{
+    nfile = BENCHCorpus(&bp,NULL);
+    if(nfile == 0){
+      cerr << "no ENSDF files in " << bp.dir << endl;
+      return -1;
+    }
+    file = new string [nfile];
+    BENCHCorpus(&bp,file);
+
+    cout << "# directory: " << bp.dir << ", " << nfile << " files" << endl;
+  }
+
+  BENCHRun(nfile,file,bp.repeat);
+
+  if(bp.dir.length() == 0) unlink(file[0].c_str());
+  delete [] file;
+
+  return 0;
+}
+
+
+/**********************************************************/
+/*      Run Each Stage                                    */
+/**********************************************************/
+void BENCHRun(const int nfile, string *file, const int repeat)
+{
+  ENSDF lib;
+  lib.memalloc(MaxDiscreteLevels,MaxGammaLines);
+  lib.setUnit("MeV");
+
+  /* adopted data sets in all files */
+  string  *fbuf = new string [nfile];
+  int     *nds  = new int [nfile];
+  DataSet **ds  = new DataSet * [nfile];
+  long    nbyte = 0, nrec = 0;
+  int     nadopt = 0;
+  for(int f=0 ; f<nfile ; f++){
+    DATAFileRead(file[f],&fbuf[f]);
+    int n = ENSDFScanDataSet(fbuf[f].c_str(),fbuf[f].length(),NULL);
+    DataSet *d = new DataSet [n];
+    ENSDFScanDataSet(fbuf[f].c_str(),fbuf[f].length(),d);
+
+    ds[f] = new DataSet [n];
+    nds[f] = 0;
+    for(int i=0 ; i<n ; i++){
+      if(d[i].type != DataSetAdopted) continue;
+      ds[f][nds[f]++] = d[i];
+      nbyte += d[i].length;
+    }
+    nadopt += nds[f];
+    delete [] d;
+  }
+
+  cout << "# " << nadopt << " adopted data sets, " << nbyte << " bytes, best of " << repeat << endl;
+  cout << "# stage               records        MB       time[s]      MB/s   records/s" << endl;
+
+  /* split into records */
+  double tbest = 0.0;
+  for(int r=0 ; r<repeat ; r++){
+    double t = 0.0;
+    nrec = 0;
+    for(int f=0 ; f<nfile ; f++){
+      ensdfbuf.swap(fbuf[f]);
+      for(int i=0 ; i<nds[f] ; i++){
+        double t0 = BENCHTime();
+        nrec += ENSDFSplitRecord(&ds[f][i]);
+        t += BENCHTime() - t0;
+        delete [] dbase;
+      }
+      ensdfbuf.swap(fbuf[f]);
+    }
+    if((r == 0) || (t < tbest)) tbest = t;
+  }
+  BENCHPrint("split",nrec,nbyte,tbest);
+
+  /* all records in one array */
+  string *rec = new string [nrec];
+  int     nr = 0;
+  for(int f=0 ; f<nfile ; f++){
+    ensdfbuf.swap(fbuf[f]);
+    for(int i=0 ; i<nds[f] ; i++){
+      int n = ENSDFSplitRecord(&ds[f][i]);
+      for(int k=0 ; k<n ; k++) rec[nr++].swap(dbase[k]);
+      delete [] dbase;
+    }
+    ensdfbuf.swap(fbuf[f]);
+  }
+  dbase = rec;
+  nline = nr;
+  long rbyte = (long)nr * (Record_Length + 1);
+
+  /* record classification, L and G records located as in ENSDFRead */
+  int nl = 0, ng = 0;
+  for(int r=0 ; r<repeat ; r++){
+    double t0 = BENCHTime();
+    nl = ng = 0;
+    for(int c=0 ; c<nline ; c++){
+      c = ENSDFSeekNextRecord('l',c,nline); if(c < 0) break;
+      nl++;
+    }
+    for(int c=0 ; c<nline ; c++){
+      c = ENSDFSeekNextRecord('g',c,nline); if(c < 0) break;
+      ng++;
+    }
+    double t = BENCHTime() - t0;
+    if((r == 0) || (t < tbest)) tbest = t;
+  }
+  BENCHPrint("classify",nline,rbyte,tbest);
+
+  int *il = new int [nl];
+  int *ig = new int [ng];
+  nl = ng = 0;
+  for(int c=0 ; c<nline ; c++){
+    c = ENSDFSeekNextRecord('l',c,nline); if(c < 0) break;
+    il[nl++] = c;
+  }
+  for(int c=0 ; c<nline ; c++){
+    c = ENSDFSeekNextRecord('g',c,nline); if(c < 0) break;
+    ig[ng++] = c;
+  }
+  long lbyte = (long)nl * (Record_Length + 1);
+  long gbyte = (long)ng * (Record_Length + 1);
+
+  /* L records */
+  for(int r=0 ; r<repeat ; r++){
+    lib.clear();
+    double t0 = BENCHTime();
+    for(int i=0 ; i<nl ; i++){
+      if(lib.getNlevel() >= lib.getNsize() - 2) lib.clear();
+      ENSDFParseLevelLine(dbase[il[i]],&lib,lib.getUnit());
+    }
+    double t = BENCHTime() - t0;
+    if((r == 0) || (t < tbest)) tbest = t;
+  }
+  BENCHPrint("level",nl,lbyte,tbest);
+
+  /* G records */
+  Gamma gam;
+  gam.memalloc(MaxGammaLines);
+  for(int r=0 ; r<repeat ; r++){
+    gam.clear();
+    double t0 = BENCHTime();
+    for(int i=0 ; i<ng ; i++){
+      if(gam.getNgamma() >= gam.getNsize() - 2) gam.clear();
+      ENSDFParseGammaLine(dbase[ig[i]],&gam,lib.getUnit());
+    }
+    double t = BENCHTime() - t0;
+    if((r == 0) || (t < tbest)) tbest = t;
+  }
+  BENCHPrint("gamma",ng,gbyte,tbest);
+
+  /* spin and parity field only */
+  int  js[Candidate_Spin], ps[Candidate_Spin];
+  long sum = 0;
+  for(int r=0 ; r<repeat ; r++){
+    double t0 = BENCHTime();
+    for(int i=0 ; i<nl ; i++) sum += ENSDFParseSpinParity(dbase[il[i]],js,ps);
+    double t = BENCHTime() - t0;
+    if((r == 0) || (t < tbest)) tbest = t;
+  }
+  BENCHPrint("spin-parity",nl,lbyte,tbest);
+
+  /* half-life field only */
+  double tsum = 0.0;
+  for(int r=0 ; r<repeat ; r++){
+    double t0 = BENCHTime();
+    for(int i=0 ; i<nl ; i++) tsum += ENSDFParseHalfLife(dbase[il[i]]);
+    double t = BENCHTime() - t0;
+    if((r == 0) || (t < tbest)) tbest = t;
+  }
+  BENCHPrint("half-life",nl,lbyte,tbest);
+
+  delete [] rec;
+  delete [] il;
+  delete [] ig;
+
+  /* whole ENSDFRead, file read once and kept in memory */
+  for(int r=0 ; r<repeat ; r++){
+    double t0 = BENCHTime();
+    for(int f=0 ; f<nfile ; f++){
+      for(int i=0 ; i<nds[f] ; i++){
+        lib.clear();
+        ENSDFRead(ds[f][i].za,"",file[f],&lib,ReadFieldAll,LevelCutoff());
+      }
+    }
+    double t = BENCHTime() - t0;
+    if((r == 0) || (t < tbest)) tbest = t;
+  }
+  BENCHPrint("ENSDFRead",nrec,nbyte,tbest);
+
+  /* keep the results used */
+  if(sum + tsum == 0.0) cout << "#" << endl;
+
+  for(int f=0 ; f<nfile ; f++) delete [] ds[f];
+  delete [] ds;
+  delete [] nds;
+  delete [] fbuf;
+}
+
+
+/**********************************************************/
+/*      Generate Synthetic Adopted Data Sets              */
+/**********************************************************/
+void BENCHGenerate(BenchParam *bp, string *buf)
+{
+  const char *jpi0[] = {"0+", "2+", "4+", "1-", "3-", "1/2+", "3/2-", "5/2+", "7/2-"};
+  const char *jpi1[] = {"(2)+", "(3/2,5/2)-", "1,2+", "(4+)", "(1/2:7/2)", "(3,4,5)", "J+2", ""};
+  const char *thalf[] = {"", "", "", "1.2 PS 3", "45 FS 5", "2.5 NS 2", "3.1 MS 2", "12.3 KEV 10", "0.35 EV 4"};
+  const char *mult[] = {"E2", "M1+E2", "E1", "[E2]", "M1", ""};
+
+  char   nucid[16], s[81];
+  double *elev = new double [bp->nlevel];
+
+  buf->clear();
+  for(int k=0 ; k<bp->ndataset ; k++){
+    /* distinct nuclides, Z = 1 - 100 */
+    int z = 1 + k % 100;
+    int a = 2*z + k / 100;
+    string e = element_name[z];
+    for(unsigned int i=0 ; i<e.length() ; i++) e[i] = toupper(e[i]);
+    snprintf(nucid,sizeof(nucid),"%3d%-2s",a,e.c_str());
+
+    BENCHRecord(buf,nucid,' ',' ',"ADOPTED LEVELS, GAMMAS");
+    BENCHRecord(buf,nucid,' ','H',"TYP=FUL$AUT=SYNTHETIC$CIT=BENCHMARK$");
+    BENCHRecord(buf,nucid,' ','Q',"-4566.6   5 11197.1   3 10183.67 16 -7613.3 4");
+    BENCHRecord(buf,nucid,'C','L',"E(level): from least-squares fit to Egamma");
+
+    double el = 0.0;
+    for(int i=0 ; i<bp->nlevel ; i++){
+      elev[i] = el;
+
+      /* L record */
+      char r[81];
+      memset(r,' ',80); r[80] = '\0';
+      snprintf(s,sizeof(s),"%10.3f",el);  BENCHField(r, 0,s);
+      snprintf(s,sizeof(s),"%-2d",1 + (int)(9*BENCHRandom())); BENCHField(r,10,s);
+      const char *j = (BENCHRandom() < bp->jpimix) ? jpi1[(int)(8*BENCHRandom())] : jpi0[(int)(9*BENCHRandom())];
+      BENCHField(r,12,j);
+      BENCHField(r,30,(i == 0) ? "STABLE" : thalf[(int)(9*BENCHRandom())]);
+      r[71] = '\0';
+      BENCHRecord(buf,nucid,' ','L',r);
+      while(BENCHRandom() < bp->cont) BENCHRecord(buf,nucid,'2','L',"XREF=ABCDEFGHIJ$%IT=100$MOMM1=+1.23 4");
+
+      /* G records to lower levels */
+      int ng = (i < bp->ngamma) ? i : bp->ngamma;
+      for(int g=0 ; g<ng ; g++){
+        int f = (int)(i*BENCHRandom());
+        memset(r,' ',80); r[80] = '\0';
+        snprintf(s,sizeof(s),"%10.3f",el - elev[f]);       BENCHField(r, 0,s);
+        BENCHField(r,10,"3");
+        snprintf(s,sizeof(s),"%8.2f",100.0*BENCHRandom());  BENCHField(r,12,s);
+        BENCHField(r,20,"15");
+        BENCHField(r,22,mult[(int)(6*BENCHRandom())]);
+        snprintf(s,sizeof(s),"%7.2E",0.01*BENCHRandom());  BENCHField(r,46,s);
+        BENCHField(r,53,"4");
+        r[71] = '\0';
+        BENCHRecord(buf,nucid,' ','G',r);
+        while(BENCHRandom() < bp->cont){
+          snprintf(s,sizeof(s),"FL=%.3f$BE2W=12.3 4",elev[f]);
+          BENCHRecord(buf,nucid,'2','G',s);
+        }
+      }
+
+      el += 0.001 + 0.2 * BENCHRandom() * 10.0 / (10.0 + i);
+    }
+
+    /* end record */
+    *buf += string(80,' ') + '\n';
+  }
+
+  delete [] elev;
+}
+
+
+/**********************************************************/
+/*      Append 80-Column Record                           */
+/**********************************************************/
+void BENCHRecord(string *buf, const char *nucid, const char c5, const char c7, const char *data)
+{
+  char r[81];
+  memset(r,' ',80);
+  r[80] = '\0';
+
+  BENCHField(r,0,nucid);
+  r[5] = c5;
+  if(c5 == 'C'){ r[5] = ' '; r[6] = 'C'; }
+  r[7] = c7;
+  BENCHField(r,9,data);
+
+  *buf += r;
+  *buf += '\n';
+}
+
+
+void BENCHField(char *r, const int col, const char *s)
+{
+  int n = strlen(s);
+  if(col + n > 80) n = 80 - col;
+  memcpy(r + col,s,n);
+}
+
+
+/**********************************************************/
+/*      Uniform Random Number, xorshift                   */
+/**********************************************************/
+double BENCHRandom()
+{
+  benchseed ^= benchseed << 13;
+  benchseed ^= benchseed >> 7;
+  benchseed ^= benchseed << 17;
+  return (double)(benchseed >> 11) / 9007199254740992.0;
+}
+
+
+/**********************************************************/
+/*      ENSDF Files in Directory                          */
+/**********************************************************/
+int BENCHCorpus(BenchParam *bp, string *file)
+{
+  int n = DATADirectoryList(bp->dir,NULL,NULL,NULL);
+  if(n == 0) return 0;
+
+  string    *name  = new string [n];
+  long long *mtime = new long long [n];
+  long long *size  = new long long [n];
+  n = DATADirectoryList(bp->dir,name,mtime,size);
+
+  /* mass-chain files ensdf.AAA, and ENSDFZZZAAA.dat */
+  int m = 0;
+  for(int i=0 ; i<n ; i++){
+    if((name[i].compare(0,6,"ensdf.") != 0) && (name[i].compare(0,5,"ENSDF") != 0)) continue;
+    if(name[i] == "ensdf.idx") continue;
+    if(file != NULL) file[m] = bp->dir + '/' + name[i];
+    m++;
+  }
+
+  delete [] name;
+  delete [] mtime;
+  delete [] size;
+
+  return m;
+}
+
+
+/**********************************************************/
+/*      Timer and Print                                   */
+/**********************************************************/
+double BENCHTime()
+{
+  return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+void BENCHPrint(const char *stage, const long nrec, const long nbyte, const double t)
+{
+  double mb = nbyte / 1048576.0;
+  double tt = (t > 0.0) ? t : 1e-9;
+
+  printf("  %-14s %12ld %10.3f %12.5f %10.1f %12.4e\n",stage,nrec,mb,t,mb/tt,nrec/tt);
+}
+
+
+/**********************************************************/
+/*      Messages                                          */
+/**********************************************************/
+void WarningMessage()
+{
+  message.str("");
+}
+
+void Notice(string)
+{
+  message.str("");
+}
+
+int TerminateCode(string module)
+{
+  cerr << "ERROR     :[" << module << "] " << message.str() << endl;
+  exit(-1);
+}
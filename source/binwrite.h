@@ -0,0 +1,54 @@
+/*
+   binwrite.h :
+        write binary data in little-endian byte order
+ */
+#include <fstream>
+#include <cstring>
+#include <stdint.h>
+
+static inline void BINWriteUInt64  (std::ofstream &, uint64_t);
+static inline void BINWriteUInt32  (std::ofstream &, uint32_t);
+static inline void BINWriteInt32   (std::ofstream &, int32_t);
+static inline void BINWriteFloat   (std::ofstream &, float);
+static inline void BINWriteDouble  (std::ofstream &, double);
+
+
+/**********************************************************/
+/*      Integers, Byte by Byte from LSB                   */
+/**********************************************************/
+void BINWriteUInt64(std::ofstream &fp, uint64_t x)
+{
+  char b[8];
+  for(int i=0 ; i<8 ; i++) b[i] = (char)((x >> (8*i)) & 0xff);
+  fp.write(b,8);
+}
+
+void BINWriteUInt32(std::ofstream &fp, uint32_t x)
+{
+  char b[4];
+  for(int i=0 ; i<4 ; i++) b[i] = (char)((x >> (8*i)) & 0xff);
+  fp.write(b,4);
+}
+
+void BINWriteInt32(std::ofstream &fp, int32_t x)
+{
+  BINWriteUInt32(fp,(uint32_t)x);
+}
+
+
+/**********************************************************/
+/*      IEEE754 Floating Point Numbers                    */
+/**********************************************************/
+void BINWriteFloat(std::ofstream &fp, float x)
+{
+  uint32_t u;
+  memcpy(&u,&x,4);
+  BINWriteUInt32(fp,u);
+}
+
+void BINWriteDouble(std::ofstream &fp, double x)
+{
+  uint64_t u;
+  memcpy(&u,&x,8);
+  BINWriteUInt64(fp,u);
+}
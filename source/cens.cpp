@@ -7,7 +7,9 @@
 /******************************************************************************/
 
 #include <iostream>
+#include <cstring>
 #include <unistd.h>
+#include <getopt.h>
 
 using namespace std;
 
@@ -18,12 +20,20 @@ using namespace std;
 
 static string version = "0.3 (Jul. 2022)";
 
+static void CENSProcess(ZAnumber, string, string, string, const int, LevelCutoff);
 static void CENSHelp(void);
 static void CENSAllocMemory(void);
 static void CENSFreeMemory(void);
 
 static bool verbflag = false;
 static ENSDF lib;
+static CheckReport chktotal;
+static DecayMatrix dmat;
+static string entryfile = "";
+static EventOption evopt;
+static string eventfile = "";
+static IsomerPopulation ipop;
+static FillOption fillopt;
 static char cfgdat[WORD_LENGTH];
 
 /**********************************************************/
@@ -43,10 +53,23 @@ int main (int argc, char *argv[])
 
   string   libname_in = "",  libname_out = "", elem = "";
   int      anum = 0, znum = 0, popt = 0;
+  LevelCutoff cut;
 
   /*** command line options */
+  static struct option longopt[] = {
+    {"emax", required_argument, NULL, 'E'},
+    {"nmax", required_argument, NULL, 'N'},
+    {"entry", required_argument, NULL, 'I'},
+    {"events", required_argument, NULL, 'M'},
+    {"seed", required_argument, NULL, 'S'},
+    {"threads", required_argument, NULL, 'T'},
+    {"time", required_argument, NULL, 't'},
+    {"fill", required_argument, NULL, 'F'},
+    {"strength", required_argument, NULL, 'G'},
+    {NULL, 0, NULL, 0}
+  };
   int p;
-  while((p = getopt(argc,argv,"o:z:a:e:p:vh")) != -1){
+  while((p = getopt_long(argc,argv,"o:z:a:e:p:vh",longopt,NULL)) != -1){
     switch(p){
     case 'o': libname_out = optarg;   break;
     case 'z': elem = optarg;
@@ -57,6 +80,40 @@ int main (int argc, char *argv[])
               }                        break;
     case 'a':  anum = atoi(optarg);    break;
     case 'p':  popt = atoi(optarg);    break;
+    case 'E':  cut.emax = atof(optarg);
+               if(cut.emax <= 0.0){
+                 message << "invalid energy cutoff " << optarg;
+                 TerminateCode("main");
+               }                       break;
+    case 'N':  if(strcmp(optarg,"auto") == 0) cut.automatic = true;
+               else{
+                 cut.nmax = atoi(optarg);
+                 if(cut.nmax <= 0){
+                   message << "invalid number of levels " << optarg;
+                   TerminateCode("main");
+                 }
+               }                       break;
+    case 'I':  entryfile = optarg;     break;
+    case 'M':  evopt.nevent = strtoull(optarg,NULL,10); break;
+    case 'S':  evopt.seed = strtoull(optarg,NULL,10);   break;
+    case 'T':  evopt.nthread = atoi(optarg);            break;
+    case 't':  if((sscanf(optarg,"%lf,%lf,%d",&ipop.tmin,&ipop.tmax,&ipop.ntime) != 3)
+                  || (ipop.tmin < 0.0) || (ipop.tmax <= ipop.tmin) || (ipop.ntime < 1)){
+                 message << "invalid time grid " << optarg;
+                 TerminateCode("main");
+               }                       break;
+    case 'F':  fillopt.emax = atof(optarg);
+               if(fillopt.emax <= 0.0){
+                 message << "invalid fill-in energy " << optarg;
+                 TerminateCode("main");
+               }                       break;
+    case 'G':  if(strcmp(optarg,"weisskopf") == 0) fillopt.model = StrengthWeisskopf;
+               else if(strcmp(optarg,"slo") == 0)  fillopt.model = StrengthSLO;
+               else if(strcmp(optarg,"glo") == 0)  fillopt.model = StrengthGLO;
+               else{
+                 message << "unknown strength function " << optarg;
+                 TerminateCode("main");
+               }                       break;
     case 'v':  verbflag = true;        break;
     case 'h':  CENSHelp();             break;
     default:                           break;
@@ -103,41 +160,209 @@ int main (int argc, char *argv[])
     ripldir = (string)cfgdat;
   }
 
+  /* conversion coefficient table, used when not given in ENSDF or RIPL */
+  if(CFGRead("ICCTable",cfgdat)){
+    message << "ICC table given by " << cfgdat;
+    Notice("main");
+    ICCTableOpen((string)cfgdat);
+  }
+
+  /* decay matrices of all nuclides are written into one file */
+  if(popt == 7){
+    if(libname_out.length() == 0){
+      message << "output file name for decay matrix not given";
+      TerminateCode("main");
+    }
+    OUTMatrixOpen(libname_out,lib.getUnit());
+  }
+
+  /* cascade events for one nuclide */
+  if(popt == 9){
+    if(libname_out.length() == 0){
+      message << "output file name for cascade events not given";
+      TerminateCode("main");
+    }
+    if((za.getZ() == 0) && (optind < argc)){
+      message << "cascade events for one nuclide only, Z and A to be given";
+      TerminateCode("main");
+    }
+    eventfile = libname_out;
+  }
+
+  /* gamma-ray emission library from all decay data sets in the given files */
+  if(popt == 5){
+    if(libname_out.length() == 0){
+      message << "output file name for decay gamma library not given";
+      TerminateCode("main");
+    }
+    if(optind >= argc){
+      message << "ENSDF files for decay gamma library not given";
+      TerminateCode("main");
+    }
+    if(za.getZ() > 0){
+      message << "decay gamma library made from all data sets in the files, Z and A not used";
+      TerminateCode("main");
+    }
+    DecayGammaLibrary dlib;
+    for(int k=optind ; k<argc ; k++) ENSDFReadDecay(ensdfdir,argv[k],lib.getUnit(),&dlib);
+    OUTFdecay(libname_out,lib.getUnit(),&dlib);
+  }
+
+  /* when Z and A are given, or no file given, process one nuclide */
+  else if((za.getZ() > 0) || (optind >= argc)){
+    CENSProcess(za,ensdfdir,libname_in,ripldir,popt,cut);
+  }
+
+  /* all adopted data sets in the given files, such as ensdf.AAA mass-chain files */
+  else{
+    for(int k=optind ; k<argc ; k++){
+      libname_in = argv[k];
+
+      int nds = ENSDFListAdopted(ensdfdir,libname_in,NULL);
+      ZAnumber *zalist = new ZAnumber [nds];
+      ENSDFListAdopted(ensdfdir,libname_in,zalist);
+
+      for(int i=0 ; i<nds ; i++) CENSProcess(zalist[i],ensdfdir,libname_in,ripldir,popt,cut);
+
+      delete [] zalist;
+    }
+  }
+
+  /* level scheme check, summary of all nuclides */
+  if(popt == 6) OUTCheckSummary(&chktotal);
+  else if(popt == 7) OUTMatrixClose();
+
+  /* free allocated */
+  CENSFreeMemory();
+
+  return 0;
+}
+
+
+/**********************************************************/
+/*      Process One Nuclide                               */
+/**********************************************************/
+void CENSProcess(ZAnumber za, string ensdfdir, string libname, string ripldir, const int popt, LevelCutoff cut)
+{
+  StatProperty stp;
+  bool statdone = false;
+
+  /* clear data of the previous nuclide */
+  lib.clear();
+
+  /* automatic Nmax, the statistical analysis needs all the L records,
+     then the data set is read again up to Nmax or Ncomp */
+  if(cut.automatic){
+    ENSDFRead(za,ensdfdir,libname,&lib,ReadFieldLevel,LevelCutoff());
+    CENSStat(&lib, &stp);
+    statdone = true;
+
+    cut.nmax = ((stp.nmax > stp.ncomp) ? stp.nmax : stp.ncomp) + 1;
+    lib.clear();
+  }
+
+  /* statistical analysis needs levels, and only number of gamma-rays */
+  bool statonly = (popt == 3) || (popt == 4);
+
   /* read ENSDF data file */
-  ENSDFRead(za,ensdfdir,libname_in,&lib);
+  ENSDFRead(za,ensdfdir,libname,&lib,(statonly) ? ReadFieldLevel : ReadFieldAll,cut);
 
   /* print raw data */
   if(popt == 1) OUTFxml(&lib);
 
+  /* statistical model analysis */
+  else if(statonly){
+    if(!statdone) CENSStat(&lib, &stp);
+
+    if(popt == 3) OUTStatAnalysis(&lib, &stp);
+    else          OUTStatDensity(&lib, &stp);
+  }
+
+  /* level scheme check, results are added to the total */
+  else if(popt == 6){
+    CheckReport chk;
+    CENSGamma(&lib,&chk);
+
+    if(chktotal.nnuclide == 0) OUTCheckHeader();
+    OUTCheckNuclide(&lib,&chk);
+    chktotal.add(&chk);
+  }
+
   else{
     /* adjust gamma-ray energies and minimum fix of branching ratios */
-    CENSGamma(&lib);
+    CENSGamma(&lib,NULL);
+
+    /* statistical gamma decay of levels without data, Ncomp determined before */
+    if(fillopt.emax > 0.0){
+      if(!statdone) CENSStat(&lib, &stp);
+      statdone = true;
+      CENSFill(&lib,&fillopt);
+    }
 
     /* read RIPL file for internal conversion coefficents if not given in ENSDF */
     if(ripldir.length() > 0) RIPLRead(ripldir,&lib);
 
+    /* the rest from the ICC table */
+    CENSConversion(&lib);
+
+    /* estimated branching ratios with these conversion coefficients */
+    CENSGammaConversion(&lib);
+
     if(popt == 2) OUTFxml(&lib);
 
-    else{
-      /* statistical model analysis */
-      StatProperty stp;
-      CENSStat(&lib, &stp);
+    /* binary decay matrix */
+    else if(popt == 7){
+      CENSMatrix(&lib,&dmat);
+      OUTMatrixWrite(&dmat);
+    }
+
+    /* populations in cascade from entry distributions */
+    else if(popt == 8){
+      CascadePopulation cp;
+      CENSMatrix(&lib,&dmat);
+      CENSCascadeEntry(entryfile,&dmat,&cp);
+      CENSCascade(&dmat,&cp);
+      OUTCascade(&dmat,&cp);
+    }
+
+    /* gamma-gamma coincidence */
+    else if(popt == 10){
+      CascadePopulation cp;
+      CoincidenceList cl;
+      CENSMatrix(&lib,&dmat);
+      CENSCascadeEntry(entryfile,&dmat,&cp);
+      CENSCascade(&dmat,&cp);
+      CENSCoincidence(&dmat,&cp,&cl);
+      OUTCoincidence(&dmat,&cl);
+    }
+
+    /* populations of long-lived states in time */
+    else if(popt == 11){
+      CascadePopulation cp;
+      CENSMatrix(&lib,&dmat);
+      CENSCascadeEntry(entryfile,&dmat,&cp);
+      CENSBateman(&dmat,&cp,&ipop);
+      OUTBateman(&dmat,&ipop);
+    }
 
-      if(popt == 3) OUTStatAnalysis(&lib, &stp);
+    /* Monte Carlo cascade events */
+    else if(popt == 9){
+      CascadePopulation cp;
+      CENSMatrix(&lib,&dmat);
+      CENSCascadeEntry(entryfile,&dmat,&cp);
+      CENSEvent(eventfile,&dmat,&cp,&evopt);
+    }
 
-      else if(popt == 4) OUTStatDensity(&lib, &stp);
+    else{
+      /* statistical model analysis */
+      if(!statdone) CENSStat(&lib, &stp);
 
-      else if(popt == 0){
+      if(popt == 0){
         /* print results in RIPL format */
         OUTFripl(stp.ncomp,stp.nmax,&lib);
       }
     }
   }
-
-  /* free allocated */
-  CENSFreeMemory();
-
-  return 0;
 }
 
 
@@ -172,6 +397,7 @@ void CENSAllocMemory()
 void CENSFreeMemory()
 {
   lib.memfree();
+  ICCTableClose();
 }
 
 
@@ -186,13 +412,41 @@ void CENSHelp()
     " % cens -z Znum -a Anum -p N\n"
     "      atomic and mass numbers are given in the command line options\n"
     "      cens looks for default location for the ENSDF file\n"
-    " % cens -p N ENSDF_file\n"
-    "      read given ENSDF file\n"
+    " % cens -p N ENSDF_file [ENSDF_file ...]\n"
+    "      read given ENSDF files, all adopted data sets in each file\n"
+    "      are processed, so mass-chain files ensdf.AAA can be given\n"
     "     -p output option\n"
     "        N = 0 (or no -p option): print RIPL format\n"
     "          = 1: raw ENSDF data in XML\n"
     "          = 2: fixed ENSDF data in XML\n"
-    "          = 3: print level density information\n";
+    "          = 3: print level density information\n"
+    "          = 4: print level density and spin distribution for plotting\n"
+    "          = 5: decay gamma-ray library from all decay data sets\n"
+    "               in the given files, written into -o file\n"
+    "          = 6: consistency check of level schemes, summary at the end\n"
+    "          = 7: decay matrices in binary CSR form, written into -o file\n"
+    "          = 8: level populations and gamma-ray intensities in cascade\n"
+    "          = 9: Monte Carlo cascade events, written into -o file,\n"
+    "               one nuclide given by -z and -a\n"
+    "          =10: gamma-gamma coincidence list in cascade\n"
+    "          =11: time-dependent populations of long-lived states\n"
+    "     --emax E  levels above E are not read\n"
+    "     --nmax N  only N levels are read\n"
+    "     --nmax auto\n"
+    "               levels up to Nmax (or Ncomp if higher) are read,\n"
+    "               where no missing level is assumed\n"
+    "     --entry file\n"
+    "               entry population distributions for -p 8-11, each line has\n"
+    "               level number and populations, the top level if not given\n"
+    "     --events N, --seed S, --threads T\n"
+    "               number of cascades, random number seed, and threads\n"
+    "               for -p 9, the events do not depend on the threads\n"
+    "     --time T1,T2,N\n"
+    "               time grid for -p 11 in sec, logarithmic if T1 > 0\n"
+    "     --fill E  levels below E without gamma-ray data decay statistically\n"
+    "               to lower levels by E1, M1, and E2, except for -p 1, 3-6\n"
+    "     --strength weisskopf|slo|glo\n"
+    "               gamma-ray strength function for --fill, glo by default\n";
   cout << endl;
   exit(0);
 }
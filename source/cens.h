@@ -1,6 +1,31 @@
 const int MaxDiscreteLevels = 10000;
 const int MaxGammaLines     = 100;
 
+/*** levels living longer than this [sec] are terminal in gamma cascades */
+const double IsomerHalfLife = 1.0e-03;
+
+/*** gamma-rays to the same final level closer than this [keV] are merged */
+const double DoubletTolerance = 1.0;
+
+/*** items checked by level scheme validator */
+const int CheckEnergy     = 0;  // gamma-ray energy not conserved
+const int CheckGammaOrder = 1;  // gamma-rays not in ascending energy order
+const int CheckLevelOrder = 2;  // level energy lower than the previous one
+const int CheckNoGamma    = 3;  // excited level without gamma-ray, not isomer
+const int CheckUnreached  = 4;  // cascade does not reach ground state or isomer
+const int CheckNoBranch   = 5;  // intensities of all gamma-rays not given
+const int CheckPartial    = 6;  // intensities of some gamma-rays not given
+const int CheckDoublet    = 7;  // gamma-rays to the same final level, not merged
+const int CheckItems      = 8;
+
+const int CheckHistogram  = 8;  // bins of energy deviation and multiplicity
+const int CheckWorst      = 10; // number of worst offenders kept
+
+/*** gamma-ray strength function models for statistical fill-in */
+const int StrengthWeisskopf = 0;
+const int StrengthSLO       = 1;  // standard Lorentzian
+const int StrengthGLO       = 2;  // generalized Lorentzian for E1
+
 
 #ifndef __ENSDF_H__
 #define __ENSDF_H__
@@ -38,6 +63,347 @@ class StatProperty{
 };
 
 
+/**********************************************************/
+/*   Gamma-Ray with Large Energy Deviation                */
+/**********************************************************/
+class CheckOffender{
+ public:
+  int    z;           // Z number
+  int    a;           // A number
+  int    level;       // index of initial level
+  double energy;      // initial level energy
+  double egamma;      // gamma-ray energy given
+  double delta;       // relative deviation from level spacing
+
+  CheckOffender(){
+    z = a = level = 0;
+    energy = egamma = delta = 0.0;
+  }
+};
+
+
+/**********************************************************/
+/*   Aggregated Results of Level Scheme Check             */
+/**********************************************************/
+class CheckReport{
+ public:
+  int    nnuclide;                    // number of nuclides checked
+  long   nlevel;                      // number of levels checked
+  long   ngamma;                      // number of gamma-rays checked
+  long   count[CheckItems];           // number of problems found
+  long   deviation[CheckHistogram];   // energy deviation, in decades from 1e-6
+  long   multiplicity[CheckHistogram];// number of gamma-rays per level
+  double dmax;                        // largest energy deviation
+  int    nworst;                      // number of worst offenders
+  CheckOffender worst[CheckWorst];    // sorted in descending deviation
+
+  CheckReport(){
+    clear();
+  }
+
+  void clear(){
+    nnuclide = 0;
+    nlevel = ngamma = 0;
+    for(int i=0 ; i<CheckItems ; i++) count[i] = 0;
+    for(int i=0 ; i<CheckHistogram ; i++) deviation[i] = multiplicity[i] = 0;
+    dmax = 0.0;
+    nworst = 0;
+  }
+
+  /* insert offender when the deviation is one of the largest */
+  void offender(CheckOffender *x){
+    if(x->delta > dmax) dmax = x->delta;
+    if((nworst == CheckWorst) && (x->delta <= worst[nworst-1].delta)) return;
+
+    int k = (nworst < CheckWorst) ? nworst++ : nworst-1;
+    for( ; (k > 0) && (worst[k-1].delta < x->delta) ; k--) worst[k] = worst[k-1];
+    worst[k] = *x;
+  }
+
+  /* accumulate results of another nuclide */
+  void add(CheckReport *x){
+    nnuclide += x->nnuclide;
+    nlevel += x->nlevel;
+    ngamma += x->ngamma;
+    for(int i=0 ; i<CheckItems ; i++) count[i] += x->count[i];
+    for(int i=0 ; i<CheckHistogram ; i++){
+      deviation[i] += x->deviation[i];
+      multiplicity[i] += x->multiplicity[i];
+    }
+    for(int i=0 ; i<x->nworst ; i++) offender(&x->worst[i]);
+    if(x->dmax > dmax) dmax = x->dmax;
+  }
+};
+
+
+/**********************************************************/
+/*   Level-to-Level Decay Matrix in CSR Form              */
+/**********************************************************/
+class DecayMatrix{
+ private:
+  int    nsize;       // allocated size for levels
+  int    msize;       // allocated size for gamma-rays
+ public:
+  int    z;           // Z number
+  int    a;           // A number
+  int    nlevel;      // number of levels
+  int    ngamma;      // number of gamma-rays, non-zero elements
+  double *energy;     // level energy
+  double *thalf;      // half-life
+  int    *spin2;      // spin of the first candidate, doubled, -1 if unknown
+  int    *parity;     // parity, +1, -1, or 0 if unknown
+  int    *offset;     // first gamma-ray of each level, nlevel+1 elements
+  int    *fstate;     // final level index
+  double *photon;     // photon branching ratio, branch / (1 + ICC)
+  double *branch;     // total branching ratio
+
+  DecayMatrix(){
+    nsize = msize = 0;
+    z = a = 0;
+    nlevel = ngamma = 0;
+  }
+
+  ~DecayMatrix(){
+    memfree();
+  }
+
+  /* memory is kept when large enough for the next nuclide */
+  void memalloc(int n, int m){
+    if(n > nsize){
+      if(nsize > 0){
+        delete [] energy; delete [] thalf;
+        delete [] spin2;  delete [] parity; delete [] offset;
+      }
+      nsize  = n;
+      energy = new double [nsize];
+      thalf  = new double [nsize];
+      spin2  = new int [nsize];
+      parity = new int [nsize];
+      offset = new int [nsize + 1];
+    }
+    if(m > msize){
+      if(msize > 0){
+        delete [] fstate; delete [] photon; delete [] branch;
+      }
+      msize  = m;
+      fstate = new int [msize];
+      photon = new double [msize];
+      branch = new double [msize];
+    }
+    nlevel = ngamma = 0;
+  }
+
+  /* cascade stops at ground state, isomers, and levels without decay */
+  bool terminal(int i){
+    if(i == 0) return true;
+    if((thalf[i] < 0.0) || (thalf[i] > IsomerHalfLife)) return true;
+
+    double s = 0.0;
+    for(int k=offset[i] ; k<offset[i+1] ; k++) s += branch[k];
+    return (s == 0.0);
+  }
+
+  void memfree(){
+    if(nsize > 0){
+      delete [] energy; delete [] thalf;
+      delete [] spin2;  delete [] parity; delete [] offset;
+      nsize = 0;
+    }
+    if(msize > 0){
+      delete [] fstate; delete [] photon; delete [] branch;
+      msize = 0;
+    }
+  }
+};
+
+
+/**********************************************************/
+/*   Populations in Gamma-Ray Cascade                     */
+/**********************************************************/
+/* arrays are level (or gamma-ray) major, and the entry
+   distributions are contiguous for each level */
+class CascadePopulation{
+ public:
+  int    nrhs;        // number of entry distributions
+  int    nlevel;      // number of levels
+  int    ngamma;      // number of gamma-rays
+  double *entry;      // initial population, nlevel x nrhs
+  double *population; // total population of level, nlevel x nrhs
+  double *intensity;  // photon emission, ngamma x nrhs
+  double *feeding;    // population stopped at ground, isomer,
+                      // or level without decay, nlevel x nrhs
+
+  CascadePopulation(){
+    nrhs = nlevel = ngamma = 0;
+  }
+
+  ~CascadePopulation(){
+    memfree();
+  }
+
+  void memalloc(int n, int m, int k){
+    memfree();
+    nlevel = n;
+    ngamma = m;
+    nrhs   = k;
+    entry      = new double [nlevel*nrhs];
+    population = new double [nlevel*nrhs];
+    intensity  = new double [ngamma*nrhs];
+    feeding    = new double [nlevel*nrhs];
+    for(int i=0 ; i<nlevel*nrhs ; i++) entry[i] = population[i] = feeding[i] = 0.0;
+    for(int i=0 ; i<ngamma*nrhs ; i++) intensity[i] = 0.0;
+  }
+
+  void memfree(){
+    if(nrhs > 0){
+      delete [] entry;
+      delete [] population;
+      delete [] intensity;
+      delete [] feeding;
+      nrhs = 0;
+    }
+  }
+};
+
+
+/**********************************************************/
+/*   Time-Dependent Populations of Long-Lived States      */
+/**********************************************************/
+class IsomerPopulation{
+ public:
+  int    nstate;      // number of long-lived states
+  int    ntime;       // number of time points
+  int    ngamma;      // number of gamma-rays
+  int    nrhs;        // number of entry distributions
+  double tmin;        // first time point
+  double tmax;        // last time point, log grid if tmin > 0
+  int    *level;      // level index of each state
+  double *lambda;     // decay constant, zero if stable
+  double *initial;    // population after prompt cascade, nstate x nrhs
+  double *time;       // time grid
+  double *population; // population of state, nrhs x ntime x nstate
+  double *rate;       // gamma-ray emission rate, nrhs x ngamma x ntime
+
+  IsomerPopulation(){
+    nstate = ngamma = nrhs = 0;
+    ntime = 10;
+    tmin = 1.0e-03;
+    tmax = 1.0e+06;
+  }
+
+  ~IsomerPopulation(){
+    memfree();
+  }
+
+  void memalloc(int n, int m, int k){
+    memfree();
+    nstate = n;
+    ngamma = m;
+    nrhs   = k;
+    level = new int [nstate];
+    lambda = new double [nstate];
+    initial = new double [nstate*nrhs];
+    time = new double [ntime];
+    population = new double [nrhs*ntime*nstate];
+    rate = new double [nrhs*ngamma*ntime];
+  }
+
+  void memfree(){
+    if(nstate > 0){
+      delete [] level;
+      delete [] lambda;
+      delete [] initial;
+      delete [] time;
+      delete [] population;
+      delete [] rate;
+      nstate = 0;
+    }
+  }
+};
+
+
+/**********************************************************/
+/*   Gamma-Gamma Coincidence in Sparse List               */
+/**********************************************************/
+class CoincidenceList{
+ private:
+  int    nsize;       // allocated size
+ public:
+  int    n;           // number of pairs
+  int    *first;      // index of the preceding gamma-ray in DecayMatrix
+  int    *second;     // index of the following gamma-ray
+  double *intensity;  // coincidence intensity per entry population
+
+  CoincidenceList(){
+    nsize = n = 0;
+  }
+
+  ~CoincidenceList(){
+    if(nsize > 0){
+      delete [] first;
+      delete [] second;
+      delete [] intensity;
+    }
+  }
+
+  /* capacity is doubled when full */
+  void add(int a, int b, double x){
+    if(n == nsize){
+      int m = (nsize == 0) ? 1024 : 2*nsize;
+      int    *f = new int [m];
+      int    *s = new int [m];
+      double *c = new double [m];
+      for(int i=0 ; i<n ; i++){ f[i] = first[i]; s[i] = second[i]; c[i] = intensity[i]; }
+      if(nsize > 0){
+        delete [] first;
+        delete [] second;
+        delete [] intensity;
+      }
+      first = f; second = s; intensity = c;
+      nsize = m;
+    }
+    first[n] = a;
+    second[n] = b;
+    intensity[n] = x;
+    n++;
+  }
+};
+
+
+/**********************************************************/
+/*   Monte Carlo Cascade Event Generation                 */
+/**********************************************************/
+class EventOption{
+ public:
+  unsigned long long nevent;  // number of cascades
+  unsigned long long seed;    // random number seed
+  int    nthread;             // number of threads, hardware if zero
+
+  EventOption(){
+    nevent = 1000000;
+    seed = 1;
+    nthread = 0;
+  }
+};
+
+
+/**********************************************************/
+/*   Statistical Gamma Decay Fill-In                      */
+/**********************************************************/
+class FillOption{
+ public:
+  double emax;        // levels below this energy are filled, zero for none
+  int    model;       // strength function model
+  double threshold;   // branches smaller than this fraction removed
+
+  FillOption(){
+    emax = 0.0;
+    model = StrengthGLO;
+    threshold = 1.0e-03;
+  }
+};
+
+
 //------------------------------------------------------------------------------
 //     Prototype Definitions
 
@@ -52,7 +418,37 @@ void WarningMessage (std::string, const double);
 void WarningMessage (std::string, std::string);
 
 // censgamma.cpp
-void CENSGamma (ENSDF *);
+void CENSGamma (ENSDF *, CheckReport *);
+void CENSGammaConversion (ENSDF *);
+int  GAMMultipolarity (ENSDF *, const int, const int);
+
+// censmatrix.cpp
+void CENSMatrix (ENSDF *, DecayMatrix *);
+
+// censcascade.cpp
+void CENSCascadeEntry (std::string, DecayMatrix *, CascadePopulation *);
+void CENSCascade (DecayMatrix *, CascadePopulation *);
+
+// censbateman.cpp
+void CENSBateman (DecayMatrix *, CascadePopulation *, IsomerPopulation *);
+
+// censcoinc.cpp
+void CENSCoincidence (DecayMatrix *, CascadePopulation *, CoincidenceList *);
+
+// censevent.cpp
+void CENSEvent (std::string, DecayMatrix *, CascadePopulation *, EventOption *);
+
+// censicc.cpp
+void ICCTableOpen (std::string);
+void ICCTableClose (void);
+void CENSConversion (ENSDF *);
+
+// censfill.cpp
+void CENSFill (ENSDF *, FillOption *);
+
+// censcheck.cpp
+void CENSCheck (ENSDF *, CheckReport *);
+void CENSCheckDoublet (ENSDF *, CheckReport *);
 
 // censstat.cpp
 void CENSStat (ENSDF *, StatProperty *);
@@ -60,9 +456,31 @@ void CENSStat (ENSDF *, StatProperty *);
 // outxml.cpp
 void OUTFxml (ENSDF *);
 
+// outdecay.cpp
+void OUTFdecay (std::string, const double, DecayGammaLibrary *);
+
 // outripl.cpp
 void OUTFripl (const int, const int, ENSDF *);
 
+// outmatrix.cpp
+void OUTMatrixOpen (std::string, const double);
+void OUTMatrixWrite (DecayMatrix *);
+void OUTMatrixClose (void);
+
+// outcascade.cpp
+void OUTCascade (DecayMatrix *, CascadePopulation *);
+
+// outbateman.cpp
+void OUTBateman (DecayMatrix *, IsomerPopulation *);
+
+// outcoinc.cpp
+void OUTCoincidence (DecayMatrix *, CoincidenceList *);
+
+// outcheck.cpp
+void OUTCheckHeader (void);
+void OUTCheckNuclide (ENSDF *, CheckReport *);
+void OUTCheckSummary (CheckReport *);
+
 // outstat.cpp
 void OUTStatAnalysis (ENSDF *, StatProperty *);
 void OUTStatDensity (ENSDF *, StatProperty *);
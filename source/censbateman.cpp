@@ -0,0 +1,197 @@
+/******************************************************************************/
+/*  censbateman.cpp                                                           */
+/*        time-dependent populations of long-lived states, Bateman solution   */
+/******************************************************************************/
+
+#include <iostream>
+#include <cmath>
+
+using namespace std;
+
+#include "cens.h"
+
+static void BATSeparate(const int, double *);
+static void BATEigenVector(const int, double *, double *, double *);
+static void BATTimeGrid(IsomerPopulation *);
+
+
+/***********************************************************/
+/*      Populations and Gamma-Ray Emission Rates in Time   */
+/***********************************************************/
+/* the level scheme is collapsed to the long-lived states, where
+   prompt cascades stop, and the transfer between them is given by
+   CENSCascade. Since the states are fed only from higher states,
+   the rate matrix is triangular, and its eigenvalues are the decay
+   constants. Populations are given in closed form by the eigenvectors,
+   which are shared by all the entry distributions. Gamma-ray emission
+   rates are those from the decay of long-lived states, and prompt
+   gamma-rays at t=0 are not included. */
+void CENSBateman(DecayMatrix *dm, CascadePopulation *cp, IsomerPopulation *ip)
+{
+  const int nl = dm->nlevel;
+  const int ng = dm->ngamma;
+  const int ne = cp->nrhs;
+  if(nl == 0) return;
+
+  /* long-lived states, in ascending level order */
+  int *state = new int [nl]; // state index of level, -1 if prompt
+  int ns = 0;
+  for(int i=0 ; i<nl ; i++) state[i] = (dm->terminal(i)) ? ns++ : -1;
+
+  ip->memalloc(ns,ng,ne);
+  for(int i=0 ; i<nl ; i++){
+    int s = state[i];
+    if(s < 0) continue;
+    ip->level[s]  = i;
+    ip->lambda[s] = (dm->thalf[i] > 0.0) ? log(2.0) / dm->thalf[i] : 0.0;
+  }
+
+  /* prompt cascades, the entry distributions in the first ne columns,
+     and decay of each state in the other columns */
+  const int nr = ne + ns;
+  CascadePopulation pc;
+  pc.memalloc(nl,ng,nr);
+  for(int i=0 ; i<nl ; i++){
+    for(int r=0 ; r<ne ; r++) pc.entry[i*nr + r] = cp->entry[i*ne + r];
+  }
+  for(int s=0 ; s<ns ; s++){
+    int i = ip->level[s];
+    for(int k=dm->offset[i] ; k<dm->offset[i+1] ; k++) pc.entry[dm->fstate[k]*nr + ne+s] += dm->branch[k];
+  }
+
+  /* cascades from states are started below them */
+  CENSCascade(dm,&pc);
+
+  for(int s=0 ; s<ns ; s++){
+    for(int r=0 ; r<ne ; r++) ip->initial[s*ne + r] = pc.feeding[ip->level[s]*nr + r];
+  }
+
+  /* decay constants used in the solution, equal ones separated */
+  double *lam = new double [ns];
+  for(int s=0 ; s<ns ; s++) lam[s] = ip->lambda[s];
+  BATSeparate(ns,lam);
+
+  /* rate matrix, dN(u)/dt = -lambda(u) N(u) + sum_s lambda(s) T(s,u) N(s) */
+  double *a = new double [ns*ns];
+  for(int u=0 ; u<ns ; u++){
+    for(int s=0 ; s<ns ; s++){
+      if(s == u) a[u*ns + s] = -lam[s];
+      else if(s > u) a[u*ns + s] = lam[s] * pc.feeding[ip->level[u]*nr + ne+s];
+      else a[u*ns + s] = 0.0;
+    }
+  }
+
+  /* photons per decay of each state, its own gamma-rays and the cascade below */
+  double *g = new double [ns*ng];
+  for(int s=0 ; s<ns ; s++){
+    for(int k=0 ; k<ng ; k++) g[s*ng + k] = pc.intensity[k*nr + ne+s];
+    int i = ip->level[s];
+    for(int k=dm->offset[i] ; k<dm->offset[i+1] ; k++) g[s*ng + k] += dm->photon[k];
+  }
+
+  /* eigenvectors in columns, unit upper triangular */
+  double *v = new double [ns*ns];
+  BATEigenVector(ns,a,lam,v);
+
+  BATTimeGrid(ip);
+
+  double *c = new double [ns];
+  double *e = new double [ns];
+  for(int r=0 ; r<ne ; r++){
+
+    /* coefficients of eigenvectors for this entry distribution */
+    for(int u=ns-1 ; u>=0 ; u--){
+      double x = ip->initial[u*ne + r];
+      for(int s=u+1 ; s<ns ; s++) x -= v[u*ns + s] * c[s];
+      c[u] = x;
+    }
+
+    double *rate = &ip->rate[r*ng*ip->ntime];
+    for(int t=0 ; t<ip->ntime ; t++){
+      for(int s=0 ; s<ns ; s++) e[s] = c[s] * exp(-lam[s] * ip->time[t]);
+
+      double *p = &ip->population[(r*ip->ntime + t)*ns];
+      for(int u=0 ; u<ns ; u++){
+        double x = 0.0;
+        for(int s=u ; s<ns ; s++) x += v[u*ns + s] * e[s];
+        p[u] = (x > 0.0) ? x : 0.0;
+      }
+
+      for(int k=0 ; k<ng ; k++) rate[k*ip->ntime + t] = 0.0;
+      for(int s=0 ; s<ns ; s++){
+        double d = lam[s] * p[s];
+        if(d == 0.0) continue;
+        for(int k=0 ; k<ng ; k++) rate[k*ip->ntime + t] += d * g[s*ng + k];
+      }
+    }
+  }
+
+  delete [] state;
+  delete [] lam;
+  delete [] a;
+  delete [] g;
+  delete [] v;
+  delete [] c;
+  delete [] e;
+}
+
+
+/***********************************************************/
+/*      Separate Equal Decay Constants                     */
+/***********************************************************/
+/* the Bateman solution for equal decay constants is the limit of
+   slightly different ones, the relative difference is kept larger
+   than eps to avoid cancellation in the closed form */
+void BATSeparate(const int ns, double *lam)
+{
+  const double eps = 1e-6;
+
+  for(int s=1 ; s<ns ; s++){
+    if(lam[s] == 0.0) continue;
+    bool moved = true;
+    while(moved){
+      moved = false;
+      for(int u=0 ; u<s ; u++){
+        if(fabs(lam[u] - lam[s]) <= eps * lam[s]){
+          lam[s] *= 1.0 + 2.0 * eps;
+          moved = true;
+        }
+      }
+    }
+  }
+}
+
+
+/***********************************************************/
+/*      Eigenvectors of Upper Triangular Rate Matrix       */
+/***********************************************************/
+/* eigenvalue -lambda(s) has the eigenvector with v(s) = 1, zero above,
+   and v(u) below by back substitution */
+void BATEigenVector(const int ns, double *a, double *lam, double *v)
+{
+  for(int i=0 ; i<ns*ns ; i++) v[i] = 0.0;
+
+  for(int s=0 ; s<ns ; s++){
+    v[s*ns + s] = 1.0;
+    for(int u=s-1 ; u>=0 ; u--){
+      double x = 0.0;
+      for(int w=u+1 ; w<=s ; w++) x += a[u*ns + w] * v[w*ns + s];
+      if(x == 0.0) continue;
+      v[u*ns + s] = x / (lam[u] - lam[s]);
+    }
+  }
+}
+
+
+/***********************************************************/
+/*      Time Grid, Logarithmic if Starting at Finite Time  */
+/***********************************************************/
+void BATTimeGrid(IsomerPopulation *ip)
+{
+  int n = ip->ntime;
+  for(int t=0 ; t<n ; t++){
+    double f = (n == 1) ? 0.0 : (double)t / (n - 1);
+    if(ip->tmin > 0.0) ip->time[t] = ip->tmin * pow(ip->tmax / ip->tmin, f);
+    else ip->time[t] = ip->tmax * f;
+  }
+}
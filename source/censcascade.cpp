@@ -0,0 +1,124 @@
+/******************************************************************************/
+/*  censcascade.cpp                                                           */
+/*        level populations in gamma-ray cascade for many entry states        */
+/******************************************************************************/
+
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+#include "cens.h"
+#include "terminate.h"
+#include "datafile.h"
+
+
+/***********************************************************/
+/*      Propagate Entry Populations down to Terminal       */
+/***********************************************************/
+/* final levels are always lower in index, so the levels are
+   processed from the top in one pass. All the entry distributions
+   are handled together in the innermost loops, which are
+   contiguous and vectorized by the compiler. */
+void CENSCascade(DecayMatrix *dm, CascadePopulation *cp)
+{
+  const int nr = cp->nrhs;
+
+  for(int i=0 ; i<dm->nlevel*nr ; i++){
+    cp->population[i] = cp->entry[i];
+    cp->feeding[i] = 0.0;
+  }
+
+  for(int i=dm->nlevel-1 ; i>=0 ; i--){
+    double *p = &cp->population[i*nr];
+
+    /* populations stay at ground state, isomers, and levels without decay */
+    if(dm->terminal(i)){
+      double *f = &cp->feeding[i*nr];
+      for(int r=0 ; r<nr ; r++) f[r] = p[r];
+      continue;
+    }
+
+    for(int k=dm->offset[i] ; k<dm->offset[i+1] ; k++){
+      double *q = &cp->population[dm->fstate[k]*nr];
+      double *g = &cp->intensity[k*nr];
+      const double b = dm->branch[k];
+      const double c = dm->photon[k];
+      for(int r=0 ; r<nr ; r++){
+        q[r] += b * p[r];
+        g[r]  = c * p[r];
+      }
+    }
+  }
+}
+
+
+/***********************************************************/
+/*      Read Entry Distributions                           */
+/***********************************************************/
+/* each line contains a level number, starting at 1 as in the RIPL
+   output, and populations of all the entry distributions. Lines
+   beginning with # are comments. When no file is given, the highest
+   level that has gamma-rays is populated. */
+void CENSCascadeEntry(string file, DecayMatrix *dm, CascadePopulation *cp)
+{
+  if(file.length() == 0){
+    cp->memalloc(dm->nlevel,dm->ngamma,1);
+    int i = dm->nlevel - 1;
+    while((i > 0) && (dm->offset[i+1] == dm->offset[i])) i--;
+    if(i >= 0) cp->entry[i] = 1.0;
+    return;
+  }
+
+  string buf;
+  if(!DATAFileRead(file,&buf)){
+    message << "entry population file " << file << " cannot open";
+    TerminateCode("CENSCascadeEntry");
+  }
+
+  /* number of distributions is given by the first data line */
+  istringstream fs(buf);
+  string line;
+  int nr = 0;
+  while(getline(fs,line)){
+    if((line.length() == 0) || (line[0] == '#')) continue;
+    istringstream ls(line);
+    int i;
+    double x;
+    ls >> i;
+    while(ls >> x) nr++;
+    break;
+  }
+  if(nr == 0){
+    message << "no entry population given in " << file;
+    TerminateCode("CENSCascadeEntry");
+  }
+
+  cp->memalloc(dm->nlevel,dm->ngamma,nr);
+
+  fs.clear();
+  fs.seekg(0);
+  int nskip = 0;
+  while(getline(fs,line)){
+    if((line.length() == 0) || (line[0] == '#')) continue;
+    istringstream ls(line);
+    int i = 0;
+    ls >> i;
+
+    /* levels beyond cutoff are ignored */
+    if((i < 1) || (i > dm->nlevel)){
+      nskip++;
+      continue;
+    }
+    for(int r=0 ; r<nr ; r++){
+      double x = 0.0;
+      if(!(ls >> x)) break;
+      cp->entry[(i-1)*nr + r] += x;
+    }
+  }
+
+  if(nskip > 0){
+    message << nskip << " entry levels not in the level scheme ignored";
+    Notice("CENSCascadeEntry");
+  }
+}
@@ -0,0 +1,122 @@
+/******************************************************************************/
+/*  censcheck.cpp                                                             */
+/*        consistency check of level scheme, results aggregated               */
+/******************************************************************************/
+
+#include <iostream>
+#include <cmath>
+
+using namespace std;
+
+#include "cens.h"
+
+static inline int CHKDecade(const double);
+
+/* tolerance of relative difference between gamma-ray energy and level spacing */
+static const double CheckEnergyTolerance = 1e-3;
+
+
+/***********************************************************/
+/*      Check Level Scheme in One Pass                     */
+/***********************************************************/
+/* final states must be determined already, and gamma-ray energies
+   and intensities are those given in ENSDF. Each level and gamma-ray
+   is visited once, and problems are only counted here. */
+void CENSCheck(ENSDF *lib, CheckReport *chk)
+{
+  chk->nnuclide++;
+
+  int nl = lib->getNlevel();
+  if(nl == 0) return;
+  chk->nlevel += nl;
+
+  /* level reaches the ground state or an isomer, final states
+     are always lower in index, so that one sweep is enough */
+  bool *reach = new bool [nl];
+  reach[0] = true;
+
+  CheckOffender x;
+  x.z = lib->getZ();
+  x.a = lib->getA();
+
+  for(int i0=1 ; i0<nl ; i0++){
+    double e0 = lib->energy[i0];
+    double t0 = lib->thalf[i0];
+    int    ng = lib->gamma[i0].ngamma;
+    double *eg = lib->gamma[i0].energy;
+    double *br = lib->gamma[i0].branch;
+    int    *fs = lib->gamma[i0].fstate;
+
+    bool isomer = (t0 < 0.0) || (t0 > IsomerHalfLife);
+
+    chk->ngamma += ng;
+    chk->multiplicity[(ng < CheckHistogram-1) ? ng : CheckHistogram-1]++;
+
+    if(e0 < lib->energy[i0-1]) chk->count[CheckLevelOrder]++;
+    if((ng == 0) && !isomer) chk->count[CheckNoGamma]++;
+
+    bool   r = isomer, order = true;
+    int    nb = 0;
+    for(int j=0 ; j<ng ; j++){
+      /* energy conservation, not given energy is in the last bin */
+      double d = (eg[j] > 0.0) ? fabs((e0 - lib->energy[fs[j]]) / eg[j] - 1.0) : HUGE_VAL;
+      chk->deviation[CHKDecade(d)]++;
+      if(d > CheckEnergyTolerance){
+        chk->count[CheckEnergy]++;
+        if(eg[j] > 0.0){
+          x.level  = i0;
+          x.energy = e0;
+          x.egamma = eg[j];
+          x.delta  = d;
+          chk->offender(&x);
+        }
+      }
+
+      if((j > 0) && (eg[j] < eg[j-1])) order = false;
+      if(br[j] > 0.0) nb++;
+      if(reach[fs[j]]) r = true;
+    }
+
+    if(!order) chk->count[CheckGammaOrder]++;
+    if(ng > 1){
+      if(nb == 0) chk->count[CheckNoBranch]++;
+      else if(nb < ng) chk->count[CheckPartial]++;
+    }
+
+    reach[i0] = r;
+    if(!r) chk->count[CheckUnreached]++;
+  }
+
+  delete [] reach;
+}
+
+
+/***********************************************************/
+/*      Count Doublet Lines Not Merged                     */
+/***********************************************************/
+/* gamma-rays to the same final level that are too far apart to be
+   one transition, flagged by GAMMergeDoublet */
+void CENSCheckDoublet(ENSDF *lib, CheckReport *chk)
+{
+  for(int i0=1 ; i0<lib->getNlevel() ; i0++){
+    for(int j=0 ; j<lib->gamma[i0].getNgamma() ; j++){
+      if(lib->gamma[i0].flag[j] == GammaDoublet) chk->count[CheckDoublet]++;
+    }
+  }
+}
+
+
+/***********************************************************/
+/*      Histogram Bin of Energy Deviation                  */
+/***********************************************************/
+/* bin 0 below 1e-6, then one decade each, last bin above 1 */
+int CHKDecade(const double d)
+{
+  double b = 1e-6;
+  int k = 0;
+  while((k < CheckHistogram-1) && (d >= b)){
+    b *= 10.0;
+    k++;
+  }
+  return k;
+}
@@ -0,0 +1,102 @@
+/******************************************************************************/
+/*  censcoinc.cpp                                                             */
+/*        gamma-gamma coincidence intensities from decay matrix               */
+/******************************************************************************/
+
+#include <iostream>
+
+using namespace std;
+
+#include "cens.h"
+
+
+/***********************************************************/
+/*      Coincidence of All Gamma-Ray Pairs in Cascade      */
+/***********************************************************/
+/* the intensity of a gamma-ray a from level i to f, followed by a
+   gamma-ray b from level j, is
+       P(i) * photon(a) * R(f,j) * photon(b)
+   where P is the level population by CENSCascade for the first entry
+   distribution, population[i*nr], and R(f,j) is the
+   probability that the cascade starting at f passes through j. The
+   reach vector R(f,.) is calculated once for each final level, and
+   shared by all the gamma-rays feeding f. Only the levels actually
+   reached are used for pairs, and pairs with non-zero intensities
+   are stored, so no G x G matrix is formed. */
+void CENSCoincidence(DecayMatrix *dm, CascadePopulation *cp, CoincidenceList *cl)
+{
+  const int nl = dm->nlevel;
+  const int ng = dm->ngamma;
+  const int nr = cp->nrhs;
+
+  /* gamma-rays feeding each level, transposed CSR */
+  int *foffset = new int [nl + 1];
+  int *fgamma  = new int [(ng > 0) ? ng : 1];
+  int *initial = new int [(ng > 0) ? ng : 1];
+  for(int i=0 ; i<=nl ; i++) foffset[i] = 0;
+  for(int i=0 ; i<nl ; i++){
+    for(int k=dm->offset[i] ; k<dm->offset[i+1] ; k++){
+      initial[k] = i;
+      foffset[dm->fstate[k] + 1]++;
+    }
+  }
+  for(int i=0 ; i<nl ; i++) foffset[i+1] += foffset[i];
+
+  int *fill = new int [nl];
+  for(int i=0 ; i<nl ; i++) fill[i] = foffset[i];
+  for(int k=0 ; k<ng ; k++) fgamma[fill[dm->fstate[k]]++] = k;
+  delete [] fill;
+
+  /* terminal levels are checked once */
+  bool *term = new bool [nl];
+  for(int i=0 ; i<nl ; i++) term[i] = dm->terminal(i);
+
+  double *reach = new double [nl];
+  int    *list  = new int [nl];
+  for(int i=0 ; i<nl ; i++) reach[i] = 0.0;
+
+  for(int f=1 ; f<nl ; f++){
+    if(term[f]) continue;
+
+    /* photons feeding this level, from non-terminal levels */
+    bool fed = false;
+    for(int m=foffset[f] ; m<foffset[f+1] ; m++){
+      int a = fgamma[m];
+      if(!term[initial[a]] && (cp->population[initial[a]*nr] * dm->photon[a] > 0.0)) fed = true;
+    }
+    if(!fed) continue;
+
+    /* reach vector from f, decaying levels reached are listed */
+    int nlist = 0;
+    reach[f] = 1.0;
+    for(int j=f ; j>0 ; j--){
+      if((reach[j] == 0.0) || term[j]) continue;
+      list[nlist++] = j;
+      for(int k=dm->offset[j] ; k<dm->offset[j+1] ; k++) reach[dm->fstate[k]] += reach[j] * dm->branch[k];
+    }
+
+    for(int m=foffset[f] ; m<foffset[f+1] ; m++){
+      int a = fgamma[m];
+      if(term[initial[a]]) continue;
+      double wa = cp->population[initial[a]*nr] * dm->photon[a];
+      if(wa == 0.0) continue;
+
+      for(int l=0 ; l<nlist ; l++){
+        int j = list[l];
+        for(int k=dm->offset[j] ; k<dm->offset[j+1] ; k++){
+          double x = wa * reach[j] * dm->photon[k];
+          if(x > 0.0) cl->add(a,k,x);
+        }
+      }
+    }
+
+    for(int j=0 ; j<=f ; j++) reach[j] = 0.0;
+  }
+
+  delete [] foffset;
+  delete [] fgamma;
+  delete [] initial;
+  delete [] term;
+  delete [] reach;
+  delete [] list;
+}
@@ -0,0 +1,311 @@
+/******************************************************************************/
+/*  censevent.cpp                                                             */
+/*        Monte Carlo sampling of gamma-ray cascades, binary event file       */
+/******************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <thread>
+#include <chrono>
+#include <stdint.h>
+
+using namespace std;
+
+#include "cens.h"
+#include "terminate.h"
+#include "binwrite.h"
+
+static const char EventMagic[] = "CENSEVT1";
+static const unsigned long long EventBatch = 1 << 20;  // events written at once
+
+/**********************************************************/
+/*   Walker Alias Table                                   */
+/**********************************************************/
+class AliasTable{
+ public:
+  int      n;         // number of outcomes
+  double   *prob;     // probability to keep the column
+  uint32_t *alias;    // outcome taken otherwise
+
+  AliasTable(){
+    n = 0;
+  }
+
+  ~AliasTable(){
+    if(n > 0){
+      delete [] prob;
+      delete [] alias;
+    }
+  }
+
+  void memalloc(int m){
+    n = m;
+    prob = new double [n];
+    alias = new uint32_t [n];
+  }
+};
+
+
+/**********************************************************/
+/*   Event Records Produced by One Thread                 */
+/**********************************************************/
+class EventBuffer{
+ public:
+  size_t   nsize;     // allocated words
+  size_t   nword;     // words used
+  uint32_t *word;     // event records
+
+  EventBuffer(){
+    nsize = nword = 0;
+    word = NULL;
+  }
+
+  ~EventBuffer(){
+    if(word != NULL) delete [] word;
+  }
+
+  /* room for m more words, capacity doubled */
+  void reserve(size_t m){
+    if(nword + m <= nsize) return;
+    size_t n = (nsize == 0) ? 4096 : nsize;
+    while(nword + m > n) n *= 2;
+    uint32_t *w = new uint32_t [n];
+    for(size_t i=0 ; i<nword ; i++) w[i] = word[i];
+    if(word != NULL) delete [] word;
+    word = w;
+    nsize = n;
+  }
+};
+
+
+static void EVTAliasBuild(const int, double *, double *, uint32_t *);
+static void EVTGenerate(DecayMatrix *, AliasTable *, AliasTable *, const uint64_t, const unsigned long long, const unsigned long long, EventBuffer *);
+static inline uint64_t EVTMix(uint64_t);
+static inline uint32_t EVTAliasDraw(const uint64_t, const int, const double *, const uint32_t *);
+static void EVTWriteWords(ofstream &, uint32_t *, const size_t);
+
+
+/***********************************************************/
+/*      Generate Cascade Events                            */
+/***********************************************************/
+/* little-endian
+     header   char[8]  magic "CENSEVT1"
+              uint32   Z*1000 + A
+              uint32   number of gamma-rays in decay matrix, M
+              uint64   random number seed
+              uint64   number of events
+     table    uint32   initial level index [M]
+              uint32   final level index [M]
+              double   transition energy [M]
+     event    uint32   entry level index
+              uint32   number of transitions, n
+              uint32   transition index * 2, plus 1 for conversion electron [n]
+   random numbers of each event are given by the seed and event number
+   only, so that the events are independent of the number of threads */
+void CENSEvent(string file, DecayMatrix *dm, CascadePopulation *cp, EventOption *opt)
+{
+  int nl = dm->nlevel;
+  int ng = dm->ngamma;
+
+  /* alias tables of entry levels, first distribution in CascadePopulation */
+  AliasTable entry;
+  entry.memalloc(nl);
+  double *w = new double [(nl > 2*ng) ? nl : 2*ng];
+  double s = 0.0;
+  for(int i=0 ; i<nl ; i++){
+    w[i] = cp->entry[i*cp->nrhs];
+    s += w[i];
+  }
+  if(s <= 0.0){
+    delete [] w;
+    message << "no entry population in the level scheme";
+    TerminateCode("CENSEvent");
+  }
+  EVTAliasBuild(nl,w,entry.prob,entry.alias);
+
+  /* gamma-ray or conversion electron for each transition of all levels,
+     outcomes 2k and 2k+1 for transition k */
+  AliasTable *level = new AliasTable [nl];
+  for(int i=0 ; i<nl ; i++){
+    int m = 2 * (dm->offset[i+1] - dm->offset[i]);
+    if((m == 0) || dm->terminal(i)) continue;
+
+    for(int k=dm->offset[i] ; k<dm->offset[i+1] ; k++){
+      int j = 2 * (k - dm->offset[i]);
+      w[j  ] = dm->photon[k];
+      w[j+1] = dm->branch[k] - dm->photon[k];
+      if(w[j+1] < 0.0) w[j+1] = 0.0;
+    }
+    level[i].memalloc(m);
+    EVTAliasBuild(m,w,level[i].prob,level[i].alias);
+  }
+  delete [] w;
+
+  ofstream fp;
+  fp.open(&file[0],ios::out | ios::binary);
+  if(!fp){
+    message << "cascade event file " << file << " cannot open";
+    TerminateCode("CENSEvent");
+  }
+
+  fp.write(EventMagic,8);
+  BINWriteUInt32(fp,dm->z * 1000 + dm->a);
+  BINWriteUInt32(fp,ng);
+  BINWriteUInt64(fp,opt->seed);
+  BINWriteUInt64(fp,opt->nevent);
+  for(int i=0 ; i<nl ; i++){
+    for(int k=dm->offset[i] ; k<dm->offset[i+1] ; k++) BINWriteUInt32(fp,i);
+  }
+  for(int k=0 ; k<ng ; k++) BINWriteUInt32(fp,dm->fstate[k]);
+  for(int i=0 ; i<nl ; i++){
+    for(int k=dm->offset[i] ; k<dm->offset[i+1] ; k++) BINWriteDouble(fp,dm->energy[i] - dm->energy[dm->fstate[k]]);
+  }
+
+  int nt = opt->nthread;
+  if(nt <= 0) nt = thread::hardware_concurrency();
+  if(nt <= 0) nt = 1;
+
+  uint64_t key = EVTMix(opt->seed);
+  EventBuffer *buf = new EventBuffer [nt];
+  thread *worker = new thread [nt];
+
+  auto t0 = chrono::steady_clock::now();
+
+  /* each batch is divided into the threads, written in order */
+  for(unsigned long long e0=0 ; e0<opt->nevent ; e0+=EventBatch){
+    unsigned long long ne = (opt->nevent - e0 < EventBatch) ? opt->nevent - e0 : EventBatch;
+    for(int t=0 ; t<nt ; t++){
+      unsigned long long a = e0 + ne * t / nt;
+      unsigned long long b = e0 + ne * (t + 1) / nt;
+      worker[t] = thread(EVTGenerate,dm,&entry,level,key,a,b,&buf[t]);
+    }
+    for(int t=0 ; t<nt ; t++){
+      worker[t].join();
+      EVTWriteWords(fp,buf[t].word,buf[t].nword);
+    }
+  }
+  fp.close();
+
+  double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+  message << opt->nevent << " cascades generated in " << sec << " sec with " << nt << " threads";
+  Notice("CENSEvent");
+
+  delete [] worker;
+  delete [] buf;
+  delete [] level;
+}
+
+
+/***********************************************************/
+/*      Sample Events in a Range                           */
+/***********************************************************/
+void EVTGenerate(DecayMatrix *dm, AliasTable *entry, AliasTable *level, const uint64_t key, const unsigned long long e0, const unsigned long long e1, EventBuffer *buf)
+{
+  buf->nword = 0;
+  if(entry->n == 0) return;
+
+  for(unsigned long long e=e0 ; e<e1 ; e++){
+    /* counter-based stream for this event */
+    uint64_t s = EVTMix(key ^ EVTMix(e));
+    uint64_t c = 0;
+
+    uint32_t i = EVTAliasDraw(EVTMix(s + c++),entry->n,entry->prob,entry->alias);
+
+    /* at most i transitions, since final levels are lower */
+    buf->reserve(i + 2);
+    size_t h = buf->nword;
+    buf->word[h] = i;
+    buf->nword += 2;
+
+    while(level[i].n > 0){
+      uint32_t o = EVTAliasDraw(EVTMix(s + c++),level[i].n,level[i].prob,level[i].alias);
+      uint32_t k = dm->offset[i] + o/2;
+      buf->word[buf->nword++] = 2*k + (o & 1);
+      i = dm->fstate[k];
+    }
+    buf->word[h+1] = buf->nword - h - 2;
+  }
+}
+
+
+/***********************************************************/
+/*      Alias Table Construction, Vose's Method            */
+/***********************************************************/
+void EVTAliasBuild(const int n, double *w, double *prob, uint32_t *alias)
+{
+  double s = 0.0;
+  for(int i=0 ; i<n ; i++) s += w[i];
+  if(s <= 0.0){
+    for(int i=0 ; i<n ; i++){ prob[i] = 1.0; alias[i] = i; }
+    return;
+  }
+
+  /* small and large columns, stacked in one array from both ends */
+  int *stack = new int [n];
+  int ns = 0, nb = n;
+  for(int i=0 ; i<n ; i++){
+    prob[i] = w[i] * n / s;
+    alias[i] = i;
+    if(prob[i] < 1.0) stack[ns++] = i;
+    else stack[--nb] = i;
+  }
+
+  while((ns > 0) && (nb < n)){
+    int l = stack[--ns];
+    int g = stack[nb];
+    alias[l] = g;
+    prob[g] -= 1.0 - prob[l];
+    if(prob[g] < 1.0){
+      nb++;
+      stack[ns++] = g;
+    }
+  }
+
+  /* remaining columns by rounding */
+  for(int i=0 ; i<ns ; i++) prob[stack[i]] = 1.0;
+  for(int i=nb ; i<n ; i++) prob[stack[i]] = 1.0;
+
+  delete [] stack;
+}
+
+
+/***********************************************************/
+/*      Draw from Alias Table by One 64-bit Random Number  */
+/***********************************************************/
+/* upper 32 bits select the column, lower 32 bits for the probability */
+uint32_t EVTAliasDraw(const uint64_t r, const int n, const double *prob, const uint32_t *alias)
+{
+  uint32_t j = (uint32_t)(((r >> 32) * (uint64_t)n) >> 32);
+  double   u = (double)(r & 0xffffffff) * (1.0 / 4294967296.0);
+  return (u < prob[j]) ? j : alias[j];
+}
+
+
+/***********************************************************/
+/*      SplitMix64 Finalizer, Counter-Based Random Number  */
+/***********************************************************/
+uint64_t EVTMix(uint64_t z)
+{
+  z += 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+
+/***********************************************************/
+/*      Write 32-bit Words in Little-Endian                */
+/***********************************************************/
+void EVTWriteWords(ofstream &fp, uint32_t *w, const size_t n)
+{
+  const uint32_t one = 1;
+  bool little = (*(const char *)&one == 1);
+
+  if(!little){
+    for(size_t i=0 ; i<n ; i++){
+      uint32_t x = w[i];
+      w[i] = (x >> 24) | ((x >> 8) & 0xff00) | ((x << 8) & 0xff0000) | (x << 24);
+    }
+  }
+  fp.write((const char *)w,n * sizeof(uint32_t));
+}
@@ -0,0 +1,250 @@
+/******************************************************************************/
+/*  censfill.cpp                                                              */
+/*        statistical gamma decay of levels without gamma-ray data            */
+/******************************************************************************/
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+using namespace std;
+
+#include "cens.h"
+#include "terminate.h"
+
+static const double FillStep  = 1.0e-03;   // energy step of strength table [MeV]
+static const int    FillMulti = 3;         // E1, M1, and E2
+
+/**********************************************************/
+/*   Gamma-Ray Width Table of One Nuclide                 */
+/**********************************************************/
+class StrengthTable{
+ public:
+  int      n;         // number of energy points
+  double   *width[FillMulti];  // f_XL(E) E^(2L+1), E1, M1, E2
+
+  StrengthTable(){
+    n = 0;
+  }
+
+  ~StrengthTable(){
+    if(n > 0){
+      for(int m=0 ; m<FillMulti ; m++) delete [] width[m];
+    }
+  }
+
+  void memalloc(int k){
+    n = k;
+    for(int m=0 ; m<FillMulti ; m++) width[m] = new double [n];
+  }
+
+  /* linear interpolation, energy in MeV */
+  inline double value(const int m, const double e){
+    double x = e / FillStep;
+    int    k = (int)x;
+    if(k >= n-1) return width[m][n-1];
+    return width[m][k] + (x - k) * (width[m][k+1] - width[m][k]);
+  }
+};
+
+
+static void   FILTable(const int, const int, const double, const int, StrengthTable *);
+static double FILStandardLorentzian(const double, const double, const double, const double, const int);
+static double FILGeneralizedLorentzian(const double, const double, const double, const double);
+static int    FILAllowed(Spin *, Spin *);
+static int    FILWeightCompare(const void *, const void *);
+
+
+/***********************************************************/
+/*      Fill Gamma Decay of Levels by Statistical Model    */
+/***********************************************************/
+/* levels below the cutoff energy that have no gamma-ray data
+   decay to all lower levels allowed by the spin and parity selection
+   rules for E1, M1, and E2. The branching ratios are proportional to
+   f_XL(E) E^(2L+1), and small branches are removed. Long-lived levels
+   are not filled, since they may decay by other modes. */
+void CENSFill(ENSDF *lib, FillOption *opt)
+{
+  const int nl = lib->getNlevel();
+  if((opt->emax <= 0.0) || (nl <= 1)) return;
+
+  /* highest level to be filled */
+  int top = 0;
+  for(int i=1 ; i<nl ; i++) if(lib->getEnergy(i) <= opt->emax) top = i;
+  if(top == 0) return;
+
+  /* energy conversion factor to MeV */
+  double mev = lib->getUnit() * 1.0e-06;
+
+  StrengthTable tab;
+  FILTable(lib->getZ(),lib->getA(),lib->getEnergy(top) * mev,opt->model,&tab);
+
+  double *w = new double [nl];
+  double *s = new double [nl];
+  int nfill = 0;
+
+  for(int i=1 ; i<=top ; i++){
+    if(lib->gamma[i].getNgamma() > 0) continue;
+    double t = lib->getThalf(i);
+    if((t < 0.0) || (t > IsomerHalfLife)) continue;
+
+    Spin *si = (lib->nspin[i] > 0) ? &lib->spin[i][0] : NULL;
+
+    /* relative widths to lower levels, in descending order of final levels */
+    double sum = 0.0;
+    for(int f=i-1 ; f>=0 ; f--){
+      w[f] = 0.0;
+      double eg = (lib->getEnergy(i) - lib->getEnergy(f)) * mev;
+      if(eg <= 0.0) continue;
+
+      Spin *sf = (lib->nspin[f] > 0) ? &lib->spin[f][0] : NULL;
+      int rule = FILAllowed(si,sf);
+      for(int m=0 ; m<FillMulti ; m++){
+        if(rule & (1 << m)) w[f] += tab.value(m,eg);
+      }
+      sum += w[f];
+    }
+    if(sum <= 0.0) continue;
+
+    /* small branches removed, and number limited by allocated size */
+    double cut = opt->threshold * sum;
+    int ncand = 0;
+    for(int f=0 ; f<i ; f++) if(w[f] >= cut) s[ncand++] = w[f];
+
+    int nmax = lib->gamma[i].getNsize() - 1;
+    if(ncand > nmax){
+      qsort(s,ncand,sizeof(double),FILWeightCompare);
+      cut = s[nmax-1];
+    }
+
+    /* ascending gamma-ray energies, as in ENSDF */
+    sum = 0.0;
+    for(int f=i-1 ; f>=0 ; f--){
+      if((w[f] <= 0.0) || (w[f] < cut)) continue;
+      if(!lib->gamma[i].setGamma(lib->getEnergy(i) - lib->getEnergy(f),w[f],0.0)) break;
+      int j = lib->gamma[i].getNgamma() - 1;
+      lib->gamma[i].fstate[j] = f;
+      lib->gamma[i].flag[j] = GammaFilled;
+      sum += w[f];
+    }
+
+    for(int j=0 ; j<lib->gamma[i].getNgamma() ; j++) lib->gamma[i].branch[j] /= sum;
+    nfill ++;
+  }
+
+  message << nfill << " levels filled by statistical gamma decay";
+  Notice("CENSFill");
+
+  delete [] w;
+  delete [] s;
+}
+
+
+/***********************************************************/
+/*      Tabulate Gamma-Ray Widths                          */
+/***********************************************************/
+/* strength functions by RIPL systematics, GDR for E1, spin-flip
+   resonance for M1, and isoscalar GQR for E2. The M1 strength is
+   normalized to f_E1 / f_M1 = 0.0588 A^0.878 at 7 MeV. The GLO
+   model is taken at zero temperature of final states. */
+void FILTable(const int z, const int a, const double emax, const int model, StrengthTable *tab)
+{
+  double da = (double)a;
+  double a3 = pow(da,1.0/3.0);
+
+  tab->memalloc((int)(emax / FillStep) + 2);
+
+  if(model == StrengthWeisskopf){
+    for(int k=0 ; k<tab->n ; k++){
+      double e  = k * FillStep;
+      double e3 = e * e * e;
+      tab->width[0][k] = 1.0e+14 * a3 * a3 * e3;
+      tab->width[1][k] = 5.6e+13 * e3;
+      tab->width[2][k] = 7.3e+07 * a3 * a3 * a3 * a3 * e3 * e * e;
+    }
+    return;
+  }
+
+  /* E1 giant dipole resonance */
+  double e1 = 31.2 / a3 + 20.6 / sqrt(a3);
+  double g1 = 0.026 * pow(e1,1.91);
+  double s1 = 1.2 * 120.0 * (a - z) * z / (da * M_PI * g1);
+
+  /* M1 spin-flip, cross section by ratio to E1 */
+  double e2 = 41.0 / a3;
+  double g2 = 4.0;
+  double r  = (model == StrengthGLO) ? FILGeneralizedLorentzian(7.0,e1,g1,s1) : FILStandardLorentzian(7.0,e1,g1,s1,1);
+  double s2 = r / (0.0588 * pow(da,0.878) * FILStandardLorentzian(7.0,e2,g2,1.0,1));
+
+  /* E2 isoscalar quadrupole */
+  double e3 = 63.0 / a3;
+  double g3 = 6.11 - 0.012 * da;
+  double s3 = 1.4e-04 * z * z * e3 / (a3 * g3);
+
+  for(int k=0 ; k<tab->n ; k++){
+    double e  = k * FillStep;
+    double x3 = e * e * e;
+    tab->width[0][k] = x3 * ((model == StrengthGLO) ? FILGeneralizedLorentzian(e,e1,g1,s1) : FILStandardLorentzian(e,e1,g1,s1,1));
+    tab->width[1][k] = x3 * FILStandardLorentzian(e,e2,g2,s2,1);
+    tab->width[2][k] = x3 * e * e * FILStandardLorentzian(e,e3,g3,s3,2);
+  }
+}
+
+
+/***********************************************************/
+/*      Standard Lorentzian Strength Function              */
+/***********************************************************/
+double FILStandardLorentzian(const double e, const double e0, const double g0, const double s0, const int l)
+{
+  const double k = (l == 1) ? 8.674e-08 : 5.204e-08;
+  double d = e * e - e0 * e0;
+  return k * s0 * g0 * g0 * pow(e,3.0 - 2.0*l) / (d * d + e * e * g0 * g0);
+}
+
+
+/***********************************************************/
+/*      Generalized Lorentzian for E1, Zero Temperature    */
+/***********************************************************/
+double FILGeneralizedLorentzian(const double e, const double e0, const double g0, const double s0)
+{
+  double d = e * e - e0 * e0;
+  double g = g0 * e * e / (e0 * e0);
+  return 8.674e-08 * s0 * g0 * e * g / (d * d + e * e * g * g);
+}
+
+
+/***********************************************************/
+/*      Multipolarities Allowed by Spin and Parity         */
+/***********************************************************/
+/* bits 0, 1, and 2 for E1, M1, and E2, no restriction if unknown */
+int FILAllowed(Spin *si, Spin *sf)
+{
+  int rule = 0;
+  for(int m=0 ; m<FillMulti ; m++){
+    int l = (m == 2) ? 2 : 1;
+    bool change = (m == 0);
+
+    if((si != NULL) && (sf != NULL)){
+      int ji = si->j, jf = sf->j;
+      if((ji >= 0) && (jf >= 0)){
+        if((abs(ji - jf) > 2*l) || (ji + jf < 2*l)) continue;
+      }
+      if((si->p != 0) && (sf->p != 0)){
+        if((si->p != sf->p) != change) continue;
+      }
+    }
+    rule |= 1 << m;
+  }
+  return rule;
+}
+
+
+/***********************************************************/
+/*      Descending Order of Weights                        */
+/***********************************************************/
+int FILWeightCompare(const void *a, const void *b)
+{
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+  return (x < y) ? 1 : ((x > y) ? -1 : 0);
+}
@@ -15,7 +15,46 @@ using namespace std;
 #include "terminate.h"
 
 static void GAMFinalState(ENSDF *);
+static void GAMMergeDoublet(ENSDF *);
+static int  GAMMergeLevel(Gamma *, const double, int *, int *);
+static void GAMFixEnergy(ENSDF *);
+static bool GAMLevelSorted(ENSDF *);
+static int  GAMFinalLevelLinear(ENSDF *, const int, const double);
+static int  GAMFinalLevelSearch(ENSDF *, const int, const double);
+static void GAMEstimateBranch(ENSDF *, const bool);
 static void GAMNormalizeBranch(ENSDF *);
+static void GAMBranchCovariance(Gamma *, const double);
+
+/* relative difference between gamma-ray energy and level spacing,
+   the same expression is used in linear and binary searches */
+static inline double GAMDeviation(const double e0, const double e1, const double eg)
+{
+  return (e0 - e1) / eg - 1.0;
+}
+
+/* Weisskopf single-particle rates [1/s] for E in MeV, c A^a E^(2L+1),
+   electric and magnetic, L = 1 to 4 */
+static const int    WeisskopfL = 4;
+static const double WeisskopfCoef[2][WeisskopfL] = {{1.0e+14, 7.3e+07, 34.0, 1.1e-05},
+                                                     {5.6e+13, 3.5e+07, 16.0, 4.5e-06}};
+static const double WeisskopfAexp[2][WeisskopfL] = {{2.0/3.0, 4.0/3.0, 2.0, 8.0/3.0},
+                                                     {0.0,     2.0/3.0, 4.0/3.0, 2.0}};
+
+/* more than one gamma-ray, and none of them has intensity */
+static inline bool GAMNoIntensity(Gamma *g)
+{
+  if(g->getNgamma() < 2) return false;
+  for(int j=0 ; j<g->getNgamma() ; j++) if(g->branch[j] > 0.0) return false;
+  return true;
+}
+
+/* more than one gamma-ray, and all of them estimated */
+static inline bool GAMAllEstimated(Gamma *g)
+{
+  if(g->getNgamma() < 2) return false;
+  for(int j=0 ; j<g->getNgamma() ; j++) if(g->flag[j] != GammaEstimated) return false;
+  return true;
+}
 
 #undef DEBUG
 #ifdef DEBUG
@@ -26,9 +65,17 @@ static void print(ENSDF *);
 /***********************************************************/
 /*      Clean Decay Matrix                                 */
 /***********************************************************/
-void CENSGamma(ENSDF *lib)
+void CENSGamma(ENSDF *lib, CheckReport *chk)
 {
   GAMFinalState(lib);
+
+  /* consistency check needs given gamma-ray energies and intensities */
+  if(chk != NULL) CENSCheck(lib,chk);
+
+  GAMMergeDoublet(lib);
+  if(chk != NULL) CENSCheckDoublet(lib,chk);
+  GAMFixEnergy(lib);
+  GAMEstimateBranch(lib,false);
   GAMNormalizeBranch(lib);
 
 #ifdef DEBUG
@@ -38,47 +85,360 @@ void CENSGamma(ENSDF *lib)
 
 
 /***********************************************************/
-/*      Find Final State and Fix Gamma-Ray Energy          */
+/*      Estimated Branches with Conversion Coefficients    */
+/***********************************************************/
+/* CENSGamma estimates the branches by the conversion coefficients
+   in ENSDF only. Those given later by RIPL or the ICC table are
+   included by calculating the estimated branches again */
+void CENSGammaConversion(ENSDF *lib)
+{
+  GAMEstimateBranch(lib,true);
+}
+
+
+/***********************************************************/
+/*      Find Final State                                   */
 /***********************************************************/
 void GAMFinalState(ENSDF *lib)
 {
-  const double eps = 1e-3;
+  /* binary search is possible when level energies are in ascending order */
+  bool sorted = GAMLevelSorted(lib);
 
   /* initial state */
   for(int i0=1 ; i0<lib->getNlevel() ; i0++){
-    double e0 = lib->getEnergy(i0);
 
     /* look at each gamma line */
     for(int j=0 ; j<lib->gamma[i0].getNgamma() ; j++){
-      double eg = lib->gamma[i0].getEnergy(j);
 
-      /* final state, determine by the least difference
+      /* final state given by FL= is taken as it is */
+      int k = lib->gamma[i0].fstate[j];
+      if((0 <= k) && (k < i0)) continue;
+
+      /* otherwise, determine by the least difference
          between level and gamma energies */
-      int    k = 0;
-      double z = abs((e0 - lib->getEnergy(k)) / eg - 1.0);
-      for(int i1=1 ; i1<=i0-1 ; i1++){
-        double e1 = lib->getEnergy(i1);
-        double r  = abs((e0 - e1) / eg - 1.0);
-        if(r < z){
-          z = r;
-          k = i1;
-        }
-      }
-      if(z > eps){
-        message << "energy mismatch detected: ";
-        message << "initial " << e0 << ": final " << lib->getEnergy(k);
-        message << ": dE = " << e0 - lib->getEnergy(k) << ": Egamma " << eg;
-        message << ": delta " << abs((e0 - lib->getEnergy(k))/eg - 1.0);
-        Notice("GAMFinalState");
-      }
+      double eg = lib->gamma[i0].getEnergy(j);
+      k = (sorted && (eg > 0.0)) ? GAMFinalLevelSearch(lib,i0,eg) : GAMFinalLevelLinear(lib,i0,eg);
 
       /* set final state */
       lib->gamma[i0].fstate[j] = k;
+    }
+  }
+}
+
+
+/***********************************************************/
+/*      Merge Doublet and Duplicated Gamma-Rays            */
+/***********************************************************/
+/* gamma-rays of a level going to the same final level are one
+   transition. When their energies agree within the tolerance, or
+   three times the combined uncertainty, the same line given twice is
+   removed, and otherwise the intensities are summed. Lines too far
+   apart to be merged are kept, and flagged as doublets, which are
+   reported by the level scheme check. */
+void GAMMergeDoublet(ENSDF *lib)
+{
+  const double tol = DoubletTolerance * 1.0e+03 / lib->getUnit();
+
+  int *order = new int [lib->gamma[0].getNsize()];
+  int *last  = new int [lib->getNlevel()];
+  for(int i=0 ; i<lib->getNlevel() ; i++) last[i] = -1;
+
+  int nmerge = 0, nlev = 0;
+  for(int i0=1 ; i0<lib->getNlevel() ; i0++){
+    if(lib->gamma[i0].getNgamma() < 2) continue;
+    int n = GAMMergeLevel(&lib->gamma[i0],tol,order,last);
+    if(n > 0){
+      nmerge += n;
+      nlev ++;
+    }
+  }
+
+  if(nmerge > 0){
+    message << nmerge << " doublet or duplicated gamma-rays merged in " << nlev << " levels";
+    Notice("GAMMergeDoublet");
+  }
+
+  delete [] order;
+  delete [] last;
+}
+
+
+/***********************************************************/
+/*      Doublets in One Level, Linear after Sort           */
+/***********************************************************/
+/* last[f] is the latest line to final level f in energy order,
+   reset before return */
+int GAMMergeLevel(Gamma *g, const double tol, int *order, int *last)
+{
+  const int ng = g->getNgamma();
+
+  /* gamma-ray energy order, insertion sort for a few lines */
+  for(int j=0 ; j<ng ; j++){
+    int k = j;
+    while((k > 0) && (g->energy[order[k-1]] > g->energy[j])){
+      order[k] = order[k-1];
+      k--;
+    }
+    order[k] = j;
+  }
+
+  /* a line is merged into the previous one to the same final level */
+  int nmerge = 0;
+  for(int k=0 ; k<ng ; k++){
+    int j = order[k];
+    int f = g->fstate[j];
+    if(f < 0) continue;
+    int a = last[f];
+    last[f] = j;
+    if(a < 0) continue;
+
+    double de = 3.0 * sqrt((double)g->denergy[a] * g->denergy[a] + (double)g->denergy[j] * g->denergy[j]);
+    if(g->energy[j] - g->energy[a] > ((de > tol) ? de : tol)){
+      if(g->flag[a] == GammaGiven) g->flag[a] = GammaDoublet;
+      g->flag[j] = GammaDoublet;
+      continue;
+    }
+
+    /* line kept in the original order */
+    int b = j;
+    if(b < a){ b = a; a = j; }
+
+    if((g->branch[a] == g->branch[b]) && (g->dbranch[a] == g->dbranch[b])){
+      if(g->flag[a] == GammaGiven) g->flag[a] = (g->flag[b] == GammaGiven) ? GammaDuplicate : g->flag[b];
+    }
+    else{
+      g->branch[a] += g->branch[b];
+      g->dbranch[a] = (float)sqrt((double)g->dbranch[a] * g->dbranch[a] + (double)g->dbranch[b] * g->dbranch[b]);
+      if(g->flag[b] == GammaDoublet) g->flag[a] = GammaDoublet;
+      else if(g->flag[a] != GammaDoublet) g->flag[a] = GammaMerged;
+    }
+    if(g->cvcoef[a] == 0.0){
+      g->cvcoef[a]  = g->cvcoef[b];
+      g->dcvcoef[a] = g->dcvcoef[b];
+    }
+    if(g->mpol[a] == 0) g->mpol[a] = g->mpol[b];
+
+    g->fstate[b] = -1;
+    last[f] = a;
+    nmerge ++;
+  }
+
+  for(int j=0 ; j<ng ; j++) if(g->fstate[j] >= 0) last[g->fstate[j]] = -1;
+  if(nmerge == 0) return 0;
+
+  /* remove merged lines */
+  int m = 0;
+  for(int j=0 ; j<ng ; j++){
+    if(g->fstate[j] < 0) continue;
+    if(m < j) g->move(m,j);
+    m++;
+  }
+  g->ngamma = m;
+
+  return nmerge;
+}
+
+
+/***********************************************************/
+/*      Fix Gamma-Ray Energy to Level Spacing              */
+/***********************************************************/
+void GAMFixEnergy(ENSDF *lib)
+{
+  for(int i0=1 ; i0<lib->getNlevel() ; i0++){
+    double e0 = lib->getEnergy(i0);
+    for(int j=0 ; j<lib->gamma[i0].getNgamma() ; j++){
+      lib->gamma[i0].energy[j] = e0 - lib->getEnergy(lib->gamma[i0].fstate[j]);
+    }
+  }
+}
 
-      /* fix gamma-ray energy */
-      lib->gamma[i0].energy[j] = e0 - lib->getEnergy(k);
+
+/***********************************************************/
+/*      Check Level Energies in Ascending Order            */
+/***********************************************************/
+bool GAMLevelSorted(ENSDF *lib)
+{
+  for(int i=1 ; i<lib->getNlevel() ; i++){
+    if(!(lib->energy[i-1] <= lib->energy[i])) return false;
+  }
+  return true;
+}
+
+
+/***********************************************************/
+/*      Final Level by Scanning All Lower Levels           */
+/***********************************************************/
+/* the first level giving the least deviation */
+int GAMFinalLevelLinear(ENSDF *lib, const int i0, const double eg)
+{
+  double e0 = lib->energy[i0];
+
+  int    k = 0;
+  double z = abs(GAMDeviation(e0,lib->energy[k],eg));
+  for(int i1=1 ; i1<=i0-1 ; i1++){
+    double r = abs(GAMDeviation(e0,lib->energy[i1],eg));
+    if(r < z){
+      z = r;
+      k = i1;
+    }
+  }
+
+  return k;
+}
+
+
+/***********************************************************/
+/*      Final Level by Binary Search                       */
+/***********************************************************/
+/* for ascending level energies and positive Eg, the deviation
+   d(i) = (e0 - E[i])/Eg - 1 is non-increasing with i, so that |d|
+   is minimum at one of the neighbors of the sign change. The same
+   level as GAMFinalLevelLinear is returned, including the case of
+   degenerated levels, where the lowest index is taken. */
+int GAMFinalLevelSearch(ENSDF *lib, const int i0, const double eg)
+{
+  double e0 = lib->energy[i0];
+  double *e = lib->energy;
+
+  /* first level in [0,i0) where d <= 0 */
+  int b0 = 0, b1 = i0;
+  while(b0 < b1){
+    int m = (b0 + b1) / 2;
+    if(GAMDeviation(e0,e[m],eg) <= 0.0) b1 = m;
+    else b0 = m + 1;
+  }
+  int kb = b0;
+  if(kb == 0) return 0;
+
+  /* below the sign change, the first level with the same deviation */
+  double da = GAMDeviation(e0,e[kb-1],eg);
+  b0 = 0; b1 = kb - 1;
+  while(b0 < b1){
+    int m = (b0 + b1) / 2;
+    if(GAMDeviation(e0,e[m],eg) <= da) b1 = m;
+    else b0 = m + 1;
+  }
+  int ka = b0;
+  if(kb == i0) return ka;
+
+  double db = GAMDeviation(e0,e[kb],eg);
+  return (abs(da) <= abs(db)) ? ka : kb;
+}
+
+
+/***********************************************************/
+/*      Estimate Branching Ratios When None Given          */
+/***********************************************************/
+/* for levels having more than one gamma-ray but no intensities,
+   relative branches are given by Weisskopf single-particle rates,
+   times (1 + ICC) when the conversion coefficient is given. The
+   multipolarity is taken from the MUL field, or the lowest one
+   allowed by the spins and parities. The gamma-rays of all such
+   levels are gathered in flat columns, and the rates are calculated
+   in one loop. When again is true, the levels estimated before are
+   recalculated, and normalized here. */
+void GAMEstimateBranch(ENSDF *lib, const bool again)
+{
+  /* count gamma-rays of levels without intensities */
+  int m = 0;
+  for(int i0=1 ; i0<lib->getNlevel() ; i0++){
+    Gamma *g = &lib->gamma[i0];
+    if((again) ? GAMAllEstimated(g) : GAMNoIntensity(g)) m += g->getNgamma();
+  }
+  if(m == 0) return;
+
+  /* coefficients of this nuclide, A-dependence included */
+  double coef[2][WeisskopfL];
+  for(int t=0 ; t<2 ; t++){
+    for(int l=0 ; l<WeisskopfL ; l++) coef[t][l] = WeisskopfCoef[t][l] * pow((double)lib->getA(),WeisskopfAexp[t][l]);
+  }
+  double mev = lib->getUnit() * 1.0e-06;
+
+  /* gamma columns, energy, coefficient, power, and ICC factor */
+  double *e = new double [m];
+  double *c = new double [m];
+  double *p = new double [m];
+  double *r = new double [m];
+
+  int k = 0;
+  for(int i0=1 ; i0<lib->getNlevel() ; i0++){
+    Gamma *g = &lib->gamma[i0];
+    if(!((again) ? GAMAllEstimated(g) : GAMNoIntensity(g))) continue;
+
+    for(int j=0 ; j<g->getNgamma() ; j++){
+      int code = GAMMultipolarity(lib,i0,j);
+      int l = code / 4;
+      int t = code % 4;
+      if(l > WeisskopfL) l = WeisskopfL;
+
+      e[k] = g->energy[j] * mev;
+      c[k] = coef[t - MultipolElectric][l-1];
+      p[k] = 2.0 * l + 1.0;
+      r[k] = 1.0 + g->cvcoef[j];
+      k++;
+    }
+  }
+
+  /* rates of all gamma-rays */
+  for(k=0 ; k<m ; k++) c[k] *= ((e[k] > 0.0) ? exp(p[k] * log(e[k])) : 0.0) * r[k];
+
+  /* back to levels, flagged as estimated */
+  k = 0;
+  int nlev = 0;
+  for(int i0=1 ; i0<lib->getNlevel() ; i0++){
+    Gamma *g = &lib->gamma[i0];
+    if(!((again) ? GAMAllEstimated(g) : GAMNoIntensity(g))) continue;
+
+    double s = 0.0;
+    for(int j=0 ; j<g->getNgamma() ; j++){
+      g->branch[j] = c[k++];
+      g->dbranch[j] = 0.0;
+      g->flag[j] = GammaEstimated;
+      s += g->branch[j];
+    }
+    if(again && (s > 0.0)){
+      for(int j=0 ; j<g->getNgamma() ; j++) g->branch[j] /= s;
     }
+    nlev++;
+  }
+
+  if(again) message << "branching ratios of " << nlev << " levels estimated again with conversion coefficients";
+  else message << "branching ratios of " << nlev << " levels estimated by Weisskopf rates";
+  Notice("GAMEstimateBranch");
+
+  delete [] e;
+  delete [] c;
+  delete [] p;
+  delete [] r;
+}
+
+
+/***********************************************************/
+/*      Multipolarity of Gamma-Ray, Given or Default       */
+/***********************************************************/
+/* code L*4 + character, always electric or magnetic. When MUL is not
+   given, the lowest L allowed by the first spin candidates, L = 1 if
+   unknown. The character not given by D or Q is determined by the
+   parity change, and electric when the parities are unknown */
+int GAMMultipolarity(ENSDF *lib, const int i0, const int j)
+{
+  int f = lib->gamma[i0].fstate[j];
+  int ji = -1, jf = -1, pi = 0, pf = 0;
+  if(lib->nspin[i0] > 0){ ji = lib->spin[i0][0].j; pi = lib->spin[i0][0].p; }
+  if((f >= 0) && (lib->nspin[f] > 0)){ jf = lib->spin[f][0].j; pf = lib->spin[f][0].p; }
+
+  int code = lib->gamma[i0].mpol[j];
+  int l = code / 4;
+  if(code == 0){
+    l = 1;
+    if((ji >= 0) && (jf >= 0) && (abs(ji - jf) > 2)) l = abs(ji - jf) / 2;
   }
+  else if(code % 4 != MultipolUnknown) return code;
+
+  int t = MultipolElectric;
+  if((pi != 0) && (pf != 0) && ((pi != pf) != (l % 2 == 1))) t = MultipolMagnetic;
+
+  return l*4 + t;
 }
 
 
@@ -91,7 +451,10 @@ void GAMNormalizeBranch(ENSDF *lib)
   for(int i0=1 ; i0<lib->getNlevel() ; i0++){
 
     /* when only one gamma-ray */
-    if(lib->gamma[i0].getNgamma() == 1) lib->gamma[i0].branch[0] = 1.0;
+    if(lib->gamma[i0].getNgamma() == 1){
+      lib->gamma[i0].branch[0] = 1.0;
+      lib->gamma[i0].dbranch[0] = 0.0;
+    }
 
     else{
       /* for each gamma decay */
@@ -101,6 +464,7 @@ void GAMNormalizeBranch(ENSDF *lib)
       }
       /* if no branching ratios given, leave them */
       if(s > 0.0){
+        GAMBranchCovariance(&lib->gamma[i0],s);
         s = 1.0 / s;
         for(int j=0 ; j<lib->gamma[i0].getNgamma() ; j++) lib->gamma[i0].branch[j] *= s;
       }
@@ -109,6 +473,52 @@ void GAMNormalizeBranch(ENSDF *lib)
 }
 
 
+/***********************************************************/
+/*      Covariance of Normalized Branching Ratios          */
+/***********************************************************/
+/* linear propagation of independent intensity uncertainties
+   sigma_k to b_i = r_i / S, where S = sum r_k and V = sum sigma_k^2,
+     Cov(b_i,b_j) = delta_ij sigma_i^2 / S^2
+                  - (r_i sigma_j^2 + r_j sigma_i^2) / S^3
+                  + r_i r_j V / S^4
+   given on un-normalized intensities, s = S */
+void GAMBranchCovariance(Gamma *gam, const double s)
+{
+  int n = gam->getNgamma();
+
+  double v = 0.0;
+  for(int k=0 ; k<n ; k++) v += (double)gam->dbranch[k] * (double)gam->dbranch[k];
+
+  /* no uncertainties given, covariance not allocated */
+  if(v == 0.0){
+    gam->delcov();
+    return;
+  }
+
+  gam->newcov();
+
+  double s2 = s * s;
+  double s3 = s2 * s;
+  double s4 = s2 * s2;
+  for(int i=0 ; i<n ; i++){
+    double ri = gam->branch[i];
+    double vi = (double)gam->dbranch[i] * (double)gam->dbranch[i];
+    for(int j=0 ; j<=i ; j++){
+      double rj = gam->branch[j];
+      double vj = (double)gam->dbranch[j] * (double)gam->dbranch[j];
+      double c  = - (ri * vj + rj * vi) / s3 + ri * rj * v / s4;
+      if(i == j) c += vi / s2;
+      gam->bcov[i*n + j] = gam->bcov[j*n + i] = c;
+    }
+  }
+
+  for(int i=0 ; i<n ; i++){
+    double c = gam->bcov[i*n + i];
+    gam->dbranch[i] = (c > 0.0) ? (float)sqrt(c) : 0.0;
+  }
+}
+
+
 #ifdef DEBUG
 /***********************************************************/
 /*      Debugging Print                                    */
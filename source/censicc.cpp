@@ -0,0 +1,304 @@
+/******************************************************************************/
+/*  censicc.cpp                                                               */
+/*        internal conversion coefficients from tabulated values              */
+/******************************************************************************/
+
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <cmath>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <stdint.h>
+
+using namespace std;
+
+#include "cens.h"
+#include "terminate.h"
+#include "datafile.h"
+
+static const char   ICCMagic[] = "CENSICC1";
+static const int    ICCMulti   = 8;     // E1 - E4 and M1 - M4
+static const int    ICCMaxL    = 4;
+static const size_t ICCHeader  = 16;    // magic, nz, and ne
+
+/**********************************************************/
+/*   Conversion Coefficient Table                         */
+/**********************************************************/
+class ICCTable{
+ public:
+  int      nz;        // Z = 1 to nz
+  int      ne;        // number of energy points
+  const double *energy;  // energy grid [MeV], ascending
+  const double *alpha;   // total coefficients [nz][ICCMulti][ne]
+  double   *lenergy;  // log of energy grid
+  char     *map;      // mapped binary file
+  size_t   mapsize;
+  double   *buf;      // energy and coefficients read from text
+
+  ICCTable(){
+    nz = ne = 0;
+    energy = alpha = NULL;
+    lenergy = NULL;
+    map = NULL;
+    mapsize = 0;
+    buf = NULL;
+  }
+
+  ~ICCTable(){
+    if(lenergy != NULL) delete [] lenergy;
+    if(map != NULL) munmap(map,mapsize);
+    if(buf != NULL) delete [] buf;
+  }
+};
+
+static ICCTable *icc = NULL;
+
+static bool   ICCMapBinary(string);
+static void   ICCReadText(string);
+static int    ICCMultiIndex(const string);
+static double ICCInterpolate(const double *, const double);
+
+
+/***********************************************************/
+/*      Open Conversion Coefficient Table                  */
+/***********************************************************/
+/* binary file, little-endian, mapped to memory
+     header   char[8]  magic "CENSICC1"
+              uint32   highest Z, nz
+              uint32   number of energy points, ne
+     grid     double   gamma-ray energy in MeV [ne]
+     table    double   total conversion coefficient [nz][8][ne]
+                       for E1, E2, E3, E4, M1, M2, M3, M4
+   otherwise, the same table in text, possibly compressed
+     ENERGY  e1 e2 ... en
+     Z  MUL  a1 a2 ... an
+   where lines starting with # are comments */
+void ICCTableOpen(string file)
+{
+  ICCTableClose();
+  icc = new ICCTable;
+
+  file = DATAFileFind(file);
+  if(!ICCMapBinary(file)) ICCReadText(file);
+
+  icc->lenergy = new double [icc->ne];
+  for(int k=0 ; k<icc->ne ; k++){
+    if((icc->energy[k] <= 0.0) || ((k > 0) && (icc->energy[k] <= icc->energy[k-1]))){
+      message << "energy grid of ICC table " << file << " not in ascending order";
+      TerminateCode("ICCTableOpen");
+    }
+    icc->lenergy[k] = log(icc->energy[k]);
+  }
+
+  message << "ICC table " << file << " Z up to " << icc->nz << ", " << icc->ne << " energy points";
+  Notice("ICCTableOpen");
+}
+
+
+void ICCTableClose()
+{
+  if(icc != NULL){
+    delete icc;
+    icc = NULL;
+  }
+}
+
+
+/***********************************************************/
+/*      Conversion Coefficients Not Given in ENSDF         */
+/***********************************************************/
+/* total coefficient for the leading multipolarity, given in MUL or
+   by spins and parities, with log-log interpolation in energy. Gamma-
+   rays outside the energy grid, or above L = 4, are left unchanged */
+void CENSConversion(ENSDF *lib)
+{
+  if(icc == NULL) return;
+
+  int z = lib->getZ();
+  if((z < 1) || (z > icc->nz)) return;
+
+  double mev = lib->getUnit() * 1.0e-06;
+  const double *az = icc->alpha + (size_t)(z - 1) * ICCMulti * icc->ne;
+
+  int n = 0;
+  for(int i0=1 ; i0<lib->getNlevel() ; i0++){
+    Gamma *g = &lib->gamma[i0];
+    for(int j=0 ; j<g->getNgamma() ; j++){
+      if(g->cvcoef[j] != 0.0) continue;
+
+      int code = GAMMultipolarity(lib,i0,j);
+      int l = code / 4;
+      if((l < 1) || (l > ICCMaxL)) continue;
+      int m = ((code % 4 == MultipolMagnetic) ? ICCMaxL : 0) + l - 1;
+
+      double c = ICCInterpolate(az + m * icc->ne,g->energy[j] * mev);
+      if(c > 0.0){
+        g->cvcoef[j] = c;
+        n++;
+      }
+    }
+  }
+
+  message << n << " conversion coefficients given by ICC table";
+  Notice("CENSConversion");
+}
+
+
+/***********************************************************/
+/*      Log-Log Interpolation in Energy                    */
+/***********************************************************/
+double ICCInterpolate(const double *a, const double e)
+{
+  const int ne = icc->ne;
+  if((e < icc->energy[0]) || (e > icc->energy[ne-1])) return 0.0;
+  if(ne == 1) return a[0];
+
+  /* interval by bisection, energy[k] <= e <= energy[k+1] */
+  int k0 = 0, k1 = ne - 1;
+  while(k1 - k0 > 1){
+    int k = (k0 + k1) / 2;
+    if(icc->energy[k] <= e) k0 = k;
+    else k1 = k;
+  }
+
+  double x = (log(e) - icc->lenergy[k0]) / (icc->lenergy[k1] - icc->lenergy[k0]);
+
+  /* linear when zero is included */
+  if((a[k0] <= 0.0) || (a[k1] <= 0.0)) return a[k0] + x * (a[k1] - a[k0]);
+  return exp(log(a[k0]) + x * (log(a[k1]) - log(a[k0])));
+}
+
+
+/***********************************************************/
+/*      Map Binary Table to Memory                         */
+/***********************************************************/
+bool ICCMapBinary(string file)
+{
+  int fd = ::open(&file[0],O_RDONLY);
+  if(fd < 0) return false;
+
+  struct stat st;
+  char head[ICCHeader];
+  if((fstat(fd,&st) != 0) || (st.st_size < (off_t)ICCHeader)
+     || (pread(fd,head,ICCHeader,0) != (ssize_t)ICCHeader) || (memcmp(head,ICCMagic,8) != 0)){
+    ::close(fd);
+    return false;
+  }
+
+  /* the table is used in place, so the byte order should be the same */
+  const uint32_t one = 1;
+  if(*(const char *)&one != 1){
+    ::close(fd);
+    message << "binary ICC table " << file << " cannot be used on big-endian machine";
+    TerminateCode("ICCTableOpen");
+  }
+
+  uint32_t nz, ne;
+  memcpy(&nz,head + 8,4);
+  memcpy(&ne,head + 12,4);
+
+  size_t need = ICCHeader + sizeof(double) * ((size_t)ne + (size_t)nz * ICCMulti * ne);
+  if((nz == 0) || (ne == 0) || ((size_t)st.st_size < need)){
+    ::close(fd);
+    message << "binary ICC table " << file << " too short";
+    TerminateCode("ICCTableOpen");
+  }
+
+  void *p = mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+  ::close(fd);
+  if(p == MAP_FAILED){
+    message << "binary ICC table " << file << " cannot be mapped";
+    TerminateCode("ICCTableOpen");
+  }
+
+  icc->map     = (char *)p;
+  icc->mapsize = st.st_size;
+  icc->nz      = nz;
+  icc->ne      = ne;
+  icc->energy  = (const double *)(icc->map + ICCHeader);
+  icc->alpha   = icc->energy + ne;
+
+  return true;
+}
+
+
+/***********************************************************/
+/*      Read Text Table                                    */
+/***********************************************************/
+void ICCReadText(string file)
+{
+  string data;
+  if(!DATAFileRead(file,&data)){
+    message << "ICC table " << file << " cannot open";
+    TerminateCode("ICCTableOpen");
+  }
+
+  /* energy grid and highest Z first */
+  istringstream is(data);
+  string line, key;
+  double x;
+  int ne = 0, nz = 0;
+  while(getline(is,line)){
+    istringstream ls(line);
+    if(!(ls >> key) || (key[0] == '#')) continue;
+    if(key == "ENERGY"){
+      ne = 0;
+      while(ls >> x) ne++;
+    }
+    else{
+      int z = atoi(key.c_str());
+      if(z > nz) nz = z;
+    }
+  }
+  if((ne == 0) || (nz == 0)){
+    message << "ENERGY line or coefficients not found in ICC table " << file;
+    TerminateCode("ICCTableOpen");
+  }
+
+  icc->nz  = nz;
+  icc->ne  = ne;
+  icc->buf = new double [ne + (size_t)nz * ICCMulti * ne];
+  for(size_t k=0 ; k<ne + (size_t)nz * ICCMulti * ne ; k++) icc->buf[k] = 0.0;
+  icc->energy = icc->buf;
+  icc->alpha  = icc->buf + ne;
+
+  is.clear();
+  is.seekg(0);
+  while(getline(is,line)){
+    istringstream ls(line);
+    if(!(ls >> key) || (key[0] == '#')) continue;
+
+    double *a = NULL;
+    if(key == "ENERGY") a = icc->buf;
+    else{
+      string mul;
+      int z = atoi(key.c_str());
+      ls >> mul;
+      int m = ICCMultiIndex(mul);
+      if((z < 1) || (m < 0)){
+        message << "unknown line in ICC table " << line;
+        TerminateCode("ICCTableOpen");
+      }
+      a = icc->buf + ne + ((size_t)(z - 1) * ICCMulti + m) * ne;
+    }
+    for(int k=0 ; k<ne ; k++) if(!(ls >> a[k])) break;
+  }
+}
+
+
+/***********************************************************/
+/*      Table Index of Multipolarity E1 - M4               */
+/***********************************************************/
+int ICCMultiIndex(const string mul)
+{
+  if(mul.length() != 2) return -1;
+  int l = mul[1] - '0';
+  if((l < 1) || (l > ICCMaxL)) return -1;
+
+  if(mul[0] == 'E' || mul[0] == 'e') return l - 1;
+  if(mul[0] == 'M' || mul[0] == 'm') return ICCMaxL + l - 1;
+  return -1;
+}
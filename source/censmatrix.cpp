@@ -0,0 +1,49 @@
+/******************************************************************************/
+/*  censmatrix.cpp                                                            */
+/*        level-to-level gamma-ray transition matrix in CSR form              */
+/******************************************************************************/
+
+#include <iostream>
+
+using namespace std;
+
+#include "cens.h"
+
+
+/***********************************************************/
+/*      Copy Processed Level Scheme into Decay Matrix      */
+/***********************************************************/
+/* final states and normalized branching ratios are given by
+   CENSGamma, the ICC may be replaced by RIPL before this */
+void CENSMatrix(ENSDF *lib, DecayMatrix *dm)
+{
+  int nl = lib->getNlevel();
+
+  int ng = 0;
+  for(int i=0 ; i<nl ; i++) ng += lib->gamma[i].getNgamma();
+
+  dm->memalloc(nl,ng);
+  dm->z = lib->getZ();
+  dm->a = lib->getA();
+  dm->nlevel = nl;
+  dm->ngamma = ng;
+
+  int k = 0;
+  for(int i=0 ; i<nl ; i++){
+    dm->energy[i] = lib->energy[i];
+    dm->thalf[i]  = lib->thalf[i];
+    dm->spin2[i]  = (int)lib->spin[i][0].j;
+    dm->parity[i] = (int)lib->spin[i][0].p;
+    if(dm->spin2[i] < 0) dm->spin2[i] = -1;
+
+    dm->offset[i] = k;
+    for(int j=0 ; j<lib->gamma[i].getNgamma() ; j++){
+      double b = lib->gamma[i].branch[j];
+      dm->fstate[k] = lib->gamma[i].fstate[j];
+      dm->branch[k] = b;
+      dm->photon[k] = b / (1.0 + lib->gamma[i].cvcoef[j]);
+      k++;
+    }
+  }
+  dm->offset[nl] = k;
+}
@@ -78,7 +78,8 @@ void CENSStat(ENSDF *lib, StatProperty *stp)
 /***********************************************************/
 int LEVELCheckCompleteness(ENSDF *lib)
 {
-  int m = 0;
+  /* all levels when nothing is missing */
+  int m = lib->getNlevel() - 1;
 
   /* when g.s. is only given */
   if(lib->getNlevel() == 1) m = 1;
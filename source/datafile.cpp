@@ -0,0 +1,615 @@
+/******************************************************************************/
+/*  datafile.cpp                                                              */
+/*        read data files, gzip and xz files are decompressed on the fly      */
+/*        members of tar archive are read through tarfile.cpp                 */
+/******************************************************************************/
+
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_LZMA
+#include <lzma.h>
+#endif
+
+using namespace std;
+
+#include "datafile.h"
+#include "terminate.h"
+
+/**********************************************************/
+/*   Internal State of Data Stream                        */
+/**********************************************************/
+class DataStreamState{
+ public:
+  FILE   *fp;                    // file pointer, NULL for tar member
+  int     format;                // plain, gzip, xz, or tar member
+  char   *block[DataBlockN];     // decompressed blocks in ring buffer
+  long    bsize[DataBlockN];     // data length in each block
+  int     head;                  // first filled block
+  int     count;                 // number of filled blocks
+  bool    eof;                   // decompression finished
+  bool    error;                 // broken compressed data
+  bool    ended;                 // end of gzip member or xz stream reached
+  bool    stop;                  // request to terminate thread
+  bool    holding;               // block[head] is being read
+  const char *chunk;             // data being read now
+  long    csize;                 // length of chunk
+  long    cpos;                  // read position in chunk
+  char   *inbuf;                 // compressed input, or plain data
+  string  member;                // tar member copied from compressed archive
+  thread  worker;
+  mutex   mtx;
+  condition_variable cv;
+#ifdef HAVE_ZLIB
+  z_stream   zs;
+#endif
+#ifdef HAVE_LZMA
+  lzma_stream xs;
+#endif
+};
+
+static int  DATAFormat         (FILE *);
+static void DATADecompress     (DataStreamState *);
+static long DATADecompressBlock(DataStreamState *, char *, bool *);
+
+
+/**********************************************************/
+/*      Open File and Detect Compression by Magic Bytes   */
+/**********************************************************/
+DataStream::DataStream()
+{
+  state = NULL;
+}
+
+DataStream::~DataStream()
+{
+  close();
+}
+
+bool DataStream::open(string file)
+{
+  close();
+
+  /* member of tar archive, served from memory */
+  string arc, mem;
+  if(TARPathSplit(file,&arc,&mem) && (mem.length() > 0)){
+    long size = 0;
+    const char *p = TARMemberMap(arc,mem,&size);
+    state = new DataStreamState;
+    if(p == NULL){
+      size = TARMemberSize(arc,mem);
+      if((size < 0) || !TARMemberRead(arc,mem,0,size,&state->member)){
+        delete state;
+        state = NULL;
+        return false;
+      }
+      p = state->member.c_str();
+    }
+    state->fp      = NULL;
+    state->format  = DataFormatTar;
+    state->count   = 0;
+    state->holding = false;
+    state->chunk   = p;
+    state->csize   = size;
+    state->cpos    = 0;
+    state->inbuf   = NULL;
+    for(int i=0 ; i<DataBlockN ; i++) state->block[i] = NULL;
+    return true;
+  }
+
+  FILE *fp = fopen(&file[0],"rb");
+  if(fp == NULL) return false;
+
+  int format = DATAFormat(fp);
+
+#ifndef HAVE_ZLIB
+  if(format == DataFormatGzip){
+    message << "gzip file " << file << " given, but compiled without zlib";
+    TerminateCode("DataStream");
+  }
+#endif
+#ifndef HAVE_LZMA
+  if(format == DataFormatXz){
+    message << "xz file " << file << " given, but compiled without liblzma";
+    TerminateCode("DataStream");
+  }
+#endif
+
+  state = new DataStreamState;
+  state->fp      = fp;
+  state->format  = format;
+  state->head    = 0;
+  state->count   = 0;
+  state->eof     = false;
+  state->error   = false;
+  state->ended   = false;
+  state->stop    = false;
+  state->holding = false;
+  state->chunk   = NULL;
+  state->csize   = 0;
+  state->cpos    = 0;
+  state->inbuf   = new char [DataBlockSize];
+  for(int i=0 ; i<DataBlockN ; i++){
+    state->block[i] = NULL;
+    state->bsize[i] = 0;
+  }
+  if(format == DataFormatPlain) return true;
+
+  for(int i=0 ; i<DataBlockN ; i++) state->block[i] = new char [DataBlockSize];
+
+#ifdef HAVE_ZLIB
+  if(format == DataFormatGzip){
+    memset(&state->zs,0,sizeof(z_stream));
+    if(inflateInit2(&state->zs,15+32) != Z_OK){   // gzip header
+      message << "zlib cannot be initialized for " << file;
+      TerminateCode("DataStream");
+    }
+  }
+#endif
+#ifdef HAVE_LZMA
+  if(format == DataFormatXz){
+    lzma_stream xs = LZMA_STREAM_INIT;
+    state->xs = xs;
+    if(lzma_stream_decoder(&state->xs,UINT64_MAX,LZMA_CONCATENATED) != LZMA_OK){
+      message << "liblzma cannot be initialized for " << file;
+      TerminateCode("DataStream");
+    }
+  }
+#endif
+
+  /* decompression runs ahead of the reader, one block at a time */
+  state->worker = thread(DATADecompress,state);
+
+  return true;
+}
+
+
+/**********************************************************/
+/*      Magic Bytes of gzip and xz                        */
+/**********************************************************/
+int DATAFormat(FILE *fp)
+{
+  unsigned char m[6] = {0,0,0,0,0,0};
+  size_t n = fread(m,1,6,fp);
+  rewind(fp);
+
+  int format = DataFormatPlain;
+  if((n >= 2) && (m[0] == 0x1f) && (m[1] == 0x8b)) format = DataFormatGzip;
+  else if((n == 6) && (m[0] == 0xfd) && (memcmp(&m[1],"7zXZ",4) == 0) && (m[5] == 0x00)) format = DataFormatXz;
+
+  return format;
+}
+
+
+/**********************************************************/
+/*      Close File and Stop Decompression Thread          */
+/**********************************************************/
+void DataStream::close()
+{
+  if(state == NULL) return;
+
+  if(state->worker.joinable()){
+    {
+      lock_guard<mutex> lk(state->mtx);
+      state->stop = true;
+    }
+    state->cv.notify_all();
+    state->worker.join();
+  }
+
+#ifdef HAVE_ZLIB
+  if(state->format == DataFormatGzip) inflateEnd(&state->zs);
+#endif
+#ifdef HAVE_LZMA
+  if(state->format == DataFormatXz) lzma_end(&state->xs);
+#endif
+
+  if(state->fp != NULL) fclose(state->fp);
+  for(int i=0 ; i<DataBlockN ; i++) if(state->block[i] != NULL) delete [] state->block[i];
+  if(state->inbuf != NULL) delete [] state->inbuf;
+  delete state;
+  state = NULL;
+}
+
+
+int DataStream::getFormat()
+{
+  return (state == NULL) ? DataFormatPlain : state->format;
+}
+
+
+/**********************************************************/
+/*      Move to Next Chunk of Data                        */
+/**********************************************************/
+bool DataStream::nextChunk()
+{
+  state->cpos = 0;
+  state->csize = 0;
+
+  /* tar member, whole data given at once */
+  if(state->format == DataFormatTar) return false;
+
+  /* plain file, read next block directly */
+  if(state->format == DataFormatPlain){
+    state->csize = fread(state->inbuf,1,DataBlockSize,state->fp);
+    state->chunk = state->inbuf;
+    return (state->csize > 0);
+  }
+
+  /* compressed, release the block just read, and wait for next one */
+  unique_lock<mutex> lk(state->mtx);
+  if(state->holding){
+    state->head = (state->head + 1) % DataBlockN;
+    state->count--;
+    state->holding = false;
+    state->cv.notify_all();
+  }
+  state->cv.wait(lk,[this]{ return (state->count > 0) || state->eof; });
+
+  if(state->count == 0){
+    if(state->error){
+      message << "compressed data broken";
+      TerminateCode("DataStream");
+    }
+    return false;
+  }
+
+  state->chunk   = state->block[state->head];
+  state->csize   = state->bsize[state->head];
+  state->holding = true;
+
+  return true;
+}
+
+
+/**********************************************************/
+/*      Read N Bytes                                      */
+/**********************************************************/
+long DataStream::read(char *buf, long n)
+{
+  if(state == NULL) return 0;
+
+  long m = 0;
+  while(m < n){
+    if(state->cpos >= state->csize){
+      /* large read from plain file, no copy through block */
+      if((state->format == DataFormatPlain) && (n - m >= DataBlockSize)){
+        long k = fread(buf + m,1,n - m,state->fp);
+        m += k;
+        if(k == 0) break;
+        continue;
+      }
+      if(!nextChunk()) break;
+    }
+    long k = state->csize - state->cpos;
+    if(k > n - m) k = n - m;
+    memcpy(buf + m,state->chunk + state->cpos,k);
+    state->cpos += k;
+    m += k;
+  }
+
+  return m;
+}
+
+
+/**********************************************************/
+/*      Skip N Bytes                                      */
+/**********************************************************/
+bool DataStream::skip(long n)
+{
+  if(state == NULL) return false;
+
+  if((state->format == DataFormatPlain) && (state->cpos >= state->csize)){
+    return (fseek(state->fp,n,SEEK_CUR) == 0);
+  }
+
+  while(n > 0){
+    if(state->cpos >= state->csize){
+      if(!nextChunk()) return false;
+    }
+    long k = state->csize - state->cpos;
+    if(k > n) k = n;
+    state->cpos += k;
+    n -= k;
+  }
+
+  return true;
+}
+
+
+/**********************************************************/
+/*      Read One Line, Same as std::getline               */
+/**********************************************************/
+bool DataStream::getline(string &str)
+{
+  str.clear();
+  if(state == NULL) return false;
+
+  bool found = false;
+  while(true){
+    if(state->cpos >= state->csize){
+      if(!nextChunk()) break;
+    }
+    found = true;
+
+    const char *p = state->chunk + state->cpos;
+    long k = state->csize - state->cpos;
+    const char *q = (const char *)memchr(p,'\n',k);
+    if(q != NULL){
+      str.append(p,q - p);
+      state->cpos += q - p + 1;
+      break;
+    }
+    str.append(p,k);
+    state->cpos += k;
+  }
+
+  return found;
+}
+
+
+/**********************************************************/
+/*      Decompression Thread                              */
+/**********************************************************/
+void DATADecompress(DataStreamState *s)
+{
+  while(true){
+    int t = 0;
+    {
+      unique_lock<mutex> lk(s->mtx);
+      s->cv.wait(lk,[s]{ return (s->count < DataBlockN) || s->stop; });
+      if(s->stop) break;
+      t = (s->head + s->count) % DataBlockN;
+    }
+
+    bool done = false;
+    long n = DATADecompressBlock(s,s->block[t],&done);
+
+    {
+      lock_guard<mutex> lk(s->mtx);
+      if(n > 0){
+        s->bsize[t] = n;
+        s->count++;
+      }
+      if(done) s->eof = true;
+    }
+    s->cv.notify_all();
+
+    if(done) break;
+  }
+}
+
+
+/**********************************************************/
+/*      Fill One Block                                    */
+/**********************************************************/
+long DATADecompressBlock(DataStreamState *s, char *out, bool *done)
+{
+  long n = 0;
+
+#if !defined(HAVE_ZLIB) && !defined(HAVE_LZMA)
+  /* not reached, compressed files are rejected when opened */
+  s->error = true;
+  *done = true;
+  out[0] = '\0';
+#endif
+
+#ifdef HAVE_ZLIB
+  if(s->format == DataFormatGzip){
+    z_stream *z = &s->zs;
+    z->next_out  = (Bytef *)out;
+    z->avail_out = DataBlockSize;
+    while(z->avail_out > 0){
+      if(z->avail_in == 0){
+        z->avail_in = fread(s->inbuf,1,DataBlockSize,s->fp);
+        z->next_in  = (Bytef *)s->inbuf;
+        /* input ends in the middle of a member, truncated file */
+        if(z->avail_in == 0){
+          if(!s->ended) s->error = true;
+          *done = true;
+          break;
+        }
+      }
+      int r = inflate(z,Z_NO_FLUSH);
+      /* concatenated gzip members */
+      if(r == Z_STREAM_END){
+        inflateReset(z);
+        s->ended = true;
+      }
+      else if(r == Z_OK) s->ended = false;
+      else{ s->error = true; *done = true; break; }
+    }
+    n = DataBlockSize - z->avail_out;
+  }
+#endif
+
+#ifdef HAVE_LZMA
+  if(s->format == DataFormatXz){
+    lzma_stream *x = &s->xs;
+    lzma_action  a = LZMA_RUN;
+    x->next_out  = (uint8_t *)out;
+    x->avail_out = DataBlockSize;
+    while(x->avail_out > 0){
+      if((x->avail_in == 0) && !feof(s->fp)){
+        x->avail_in = fread(s->inbuf,1,DataBlockSize,s->fp);
+        x->next_in  = (uint8_t *)s->inbuf;
+      }
+      if(feof(s->fp)) a = LZMA_FINISH;
+      lzma_ret r = lzma_code(x,a);
+      if(r == LZMA_STREAM_END){
+        s->ended = true;
+        *done = true;
+        break;
+      }
+      /* LZMA_BUF_ERROR at the end of truncated input */
+      else if(r != LZMA_OK){ s->error = true; *done = true; break; }
+    }
+    n = DataBlockSize - x->avail_out;
+  }
+#endif
+
+  return n;
+}
+
+
+/***********************************************************/
+/*      Read Entire File                                   */
+/***********************************************************/
+bool DATAFileRead(string file, string *buf)
+{
+  /* tar member, length known from header */
+  string arc, mem;
+  if(TARPathSplit(file,&arc,&mem) && (mem.length() > 0)){
+    long size = TARMemberSize(arc,mem);
+    return (size >= 0) && TARMemberRead(arc,mem,0,size,buf);
+  }
+
+  DataStream ds;
+  if(!ds.open(file)) return false;
+
+  buf->clear();
+
+  /* plain file, one sequential read */
+  if(ds.getFormat() == DataFormatPlain){
+    struct stat st;
+    if(stat(&file[0],&st) != 0) return false;
+    buf->resize(st.st_size);
+    if(st.st_size > 0) buf->resize(ds.read(&(*buf)[0],st.st_size));
+  }
+
+  /* compressed file, length unknown */
+  else{
+    long m = 0;
+    while(true){
+      buf->resize(m + DataBlockSize);
+      long k = ds.read(&(*buf)[m],DataBlockSize);
+      m += k;
+      if(k < DataBlockSize) break;
+    }
+    buf->resize(m);
+  }
+  ds.close();
+
+  return true;
+}
+
+
+/***********************************************************/
+/*      Read Part of File                                  */
+/***********************************************************/
+bool DATAFileReadRange(string file, const long offset, const long length, string *buf)
+{
+  string arc, mem;
+  if(TARPathSplit(file,&arc,&mem) && (mem.length() > 0)) return TARMemberRead(arc,mem,offset,length,buf);
+
+  FILE *fp = fopen(&file[0],"rb");
+  if(fp == NULL) return false;
+
+  buf->resize(length);
+  long n = 0;
+
+  /* plain file, one pread */
+  if(DATAFormat(fp) == DataFormatPlain){
+    if(length > 0) n = pread(fileno(fp),&(*buf)[0],length,offset);
+    fclose(fp);
+  }
+
+  /* offset is given in the decompressed data */
+  else{
+    fclose(fp);
+    DataStream ds;
+    if(!ds.open(file)) return false;
+    if(ds.skip(offset) && (length > 0)) n = ds.read(&(*buf)[0],length);
+    ds.close();
+  }
+
+  return (n == length);
+}
+
+
+/***********************************************************/
+/*      Look for Compressed File If Not Found              */
+/***********************************************************/
+string DATAFileFind(string file)
+{
+  const char *ext[] = {"", ".gz", ".xz"};
+
+  /* members of tar archive are not compressed individually */
+  string arc, mem;
+  if(TARPathSplit(file,&arc,&mem) && (mem.length() > 0)) return file;
+
+  for(int i=0 ; i<3 ; i++){
+    string f = file + ext[i];
+    if(access(&f[0],R_OK) == 0) return f;
+  }
+
+  return file;
+}
+
+
+/***********************************************************/
+/*      File Exists, Also in Tar Archive                   */
+/***********************************************************/
+bool DATAFileExist(string file)
+{
+  string arc, mem;
+  if(TARPathSplit(file,&arc,&mem) && (mem.length() > 0)) return (TARMemberSize(arc,mem) >= 0);
+
+  return (access(&file[0],R_OK) == 0);
+}
+
+
+/***********************************************************/
+/*      Files in Directory or in Tar Archive               */
+/***********************************************************/
+/* names are given without directory, time stamps of tar members
+   are those of the archive */
+int DATADirectoryList(string dir, string *name, long long *mtime, long long *size)
+{
+  struct stat st;
+  int n = 0;
+
+  string arc, mem;
+  if(TARPathSplit(dir,&arc,&mem)){
+    n = TARMemberList(arc,NULL,NULL);
+    if((name == NULL) || (n == 0)) return n;
+
+    long *s = new long [n];
+    TARMemberList(arc,name,s);
+    stat(&arc[0],&st);
+    for(int i=0 ; i<n ; i++){
+      mtime[i] = (long long)st.st_mtime;
+      size[i]  = (long long)s[i];
+    }
+    delete [] s;
+    return n;
+  }
+
+  DIR *dp = opendir(&dir[0]);
+  if(dp == NULL) return 0;
+
+  struct dirent *ent;
+  while((ent = readdir(dp)) != NULL){
+    string file = dir + '/' + ent->d_name;
+    if((stat(&file[0],&st) != 0) || !S_ISREG(st.st_mode)) continue;
+    if(name != NULL){
+      name[n]  = ent->d_name;
+      mtime[n] = (long long)st.st_mtime;
+      size[n]  = (long long)st.st_size;
+    }
+    n++;
+  }
+  closedir(dp);
+
+  return n;
+}
@@ -0,0 +1,54 @@
+/*
+   datafile.h :
+        read ENSDF and RIPL data files, plain or compressed by gzip / xz,
+   or members of tar archive
+ */
+#include <string>
+
+const int DataBlockSize = 262144;  // size of decompression block
+const int DataBlockN    = 4;       // number of blocks in queue
+
+const int DataFormatPlain = 0;
+const int DataFormatGzip  = 1;
+const int DataFormatXz    = 2;
+const int DataFormatTar   = 3;     // tar archive member held in memory
+
+class DataStreamState;
+
+/**********************************************************/
+/*   Sequential Reader, Decompressed in Background        */
+/**********************************************************/
+class DataStream{
+ private:
+  DataStreamState *state;
+  bool  nextChunk();
+ public:
+  DataStream();
+  ~DataStream();
+  bool  open(std::string);
+  void  close();
+  long  read(char *, long);
+  bool  getline(std::string &);
+  bool  skip(long);
+  int   getFormat();
+};
+
+
+/**************************************/
+/*      datafile.cpp                  */
+/**************************************/
+bool         DATAFileRead       (std::string, std::string *);
+bool         DATAFileReadRange  (std::string, const long, const long, std::string *);
+std::string  DATAFileFind       (std::string);
+bool         DATAFileExist      (std::string);
+int          DATADirectoryList  (std::string, std::string *, long long *, long long *);
+
+
+/**************************************/
+/*      tarfile.cpp                   */
+/**************************************/
+bool         TARPathSplit       (std::string, std::string *, std::string *);
+long         TARMemberSize      (std::string, std::string);
+const char * TARMemberMap       (std::string, std::string, long *);
+bool         TARMemberRead      (std::string, std::string, const long, const long, std::string *);
+int          TARMemberList      (std::string, std::string *, long *);
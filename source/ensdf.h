@@ -1,6 +1,46 @@
 const int Record_Length = 80;
 const int Candidate_Spin = 5;
 
+/*** data set type, determined by DSID in identification record */
+const int DataSetOther    = 0;
+const int DataSetAdopted  = 1;
+const int DataSetDecay    = 2;
+const int DataSetReaction = 3;
+
+/*** radioactive decay mode, determined by DSID of decay data set */
+const int DecayUnknown   = 0;
+const int DecayBetaMinus = 1;
+const int DecayEC        = 2;  // EC and beta-plus
+const int DecayIT        = 3;
+const int DecayAlpha     = 4;
+
+/*** Q-values given in Q record */
+const int QValueBeta    = 0;  // Q(beta-)
+const int QValueSn      = 1;  // neutron separation energy
+const int QValueSp      = 2;  // proton separation energy
+const int QValueAlpha   = 3;  // Q(alpha)
+const int QValueN       = 4;
+
+/*** fields decoded by ENSDFRead, levels are always read,
+     and G records are only counted when ReadFieldGamma is not given */
+const int ReadFieldLevel  = 0x00;
+const int ReadFieldGamma  = 0x01;  // gamma-ray energy, intensity, ICC
+const int ReadFieldQValue = 0x02;  // Q record
+const int ReadFieldAll    = ReadFieldGamma | ReadFieldQValue;
+
+/*** origin of gamma-ray data */
+const unsigned char GammaGiven     = 0;  // given in ENSDF
+const unsigned char GammaFilled    = 1;  // generated by statistical model
+const unsigned char GammaEstimated = 2;  // branching ratio estimated
+const unsigned char GammaMerged    = 3;  // doublet lines merged, intensities summed
+const unsigned char GammaDuplicate = 4;  // duplicate of this line removed
+const unsigned char GammaDoublet   = 5;  // same final level, not merged
+
+/*** multipolarity code, L*4 + character, zero if not given */
+const unsigned char MultipolUnknown  = 0;  // D or Q, character not given
+const unsigned char MultipolElectric = 1;
+const unsigned char MultipolMagnetic = 2;
+
 //------------------------------------------------------------------------------
 //     Class
 
@@ -47,6 +87,63 @@ class ZAnumber{
 };
 
 
+/**********************************************************/
+/*   Data Set Location in ENSDF File                      */
+/**********************************************************/
+class DataSet{
+ public:
+  ZAnumber za;        // Z and A numbers in NUCID
+  int      type;      // adopted, decay, reaction, or other
+  long     offset;    // byte offset of identification record
+  long     length;    // byte length up to the end record
+  char     dsid[31];  // data set identification, column 10-39
+
+  DataSet(){
+    type = DataSetOther;
+    offset = 0;
+    length = 0;
+    dsid[0] = '\0';
+  }
+};
+
+
+/**********************************************************/
+/*   Nuclide Location in RIPL File                        */
+/**********************************************************/
+class RIPLBlock{
+ public:
+  ZAnumber za;        // Z and A numbers in header
+  long     offset;    // byte offset of header line
+  long     length;    // byte length up to the last gamma-ray line
+  int      nlevel;    // number of levels in header
+  int      ngamma;    // number of gamma-rays in header
+
+  RIPLBlock(){
+    offset = 0;
+    length = 0;
+    nlevel = 0;
+    ngamma = 0;
+  }
+};
+
+
+/**********************************************************/
+/*   Cutoff of Levels to Be Read                          */
+/**********************************************************/
+class LevelCutoff{
+ public:
+  double emax;        // highest level energy, no limit if zero
+  int    nmax;        // number of levels, no limit if zero
+  bool   automatic;   // Nmax determined by statistical analysis
+
+  LevelCutoff(){
+    emax = 0.0;
+    nmax = 0;
+    automatic = false;
+  }
+};
+
+
 /**********************************************************/
 /*   Spin and Parity                                      */
 /**********************************************************/
@@ -80,15 +177,23 @@ class Gamma{
   bool     allocated; // flag to know if heap memory is allocated
  public:
   int      ngamma;    // number of gamma-rays
-  int      *fstate;   // level index of final state
+  int      *fstate;   // level index of final state, -1 if not given by FL=
   double   *energy;   // gamma-ray energy
   double   *branch;   // relative intensity or branching ratio
   double   *cvcoef;   // conversion coefficient
+  float    *denergy;  // uncertainty of gamma-ray energy
+  float    *dbranch;  // uncertainty of intensity or branching ratio
+  float    *dcvcoef;  // uncertainty of conversion coefficient
+  double   *bcov;     // covariance of branching ratios, ngamma x ngamma,
+                      // allocated only when the uncertainties are given
+  unsigned char *flag;// origin of data, GammaGiven, Filled, Estimated, etc.
+  unsigned char *mpol;// multipolarity code from MUL field
 
   Gamma(){
     nsize = 0;
     ngamma = 0;
     allocated = false;
+    bcov = NULL;
   }
 
   ~Gamma(){
@@ -102,6 +207,12 @@ class Gamma{
       energy = new double [n];
       branch = new double [n];
       cvcoef = new double [n];
+      denergy = new float [n];
+      dbranch = new float [n];
+      dcvcoef = new float [n];
+      flag = new unsigned char [n];
+      mpol = new unsigned char [n];
+      bcov = NULL;
       allocated = true;
     }
   }
@@ -113,6 +224,12 @@ class Gamma{
       delete [] energy;
       delete [] branch;
       delete [] cvcoef;
+      delete [] denergy;
+      delete [] dbranch;
+      delete [] dcvcoef;
+      delete [] flag;
+      delete [] mpol;
+      delcov();
       allocated = false;
     }
   }
@@ -122,21 +239,80 @@ class Gamma{
       for(int i=0 ; i<nsize ; i++){
         fstate[i] = 0;
         energy[i] = branch[i] = cvcoef[i] = 0.0;
+        denergy[i] = dbranch[i] = dcvcoef[i] = 0.0;
+        flag[i] = GammaGiven;
+        mpol[i] = 0;
       }
+      delcov();
+    }
+  }
+
+  void clear(){
+    for(int i=0 ; i<ngamma ; i++){
+      fstate[i] = 0;
+      energy[i] = branch[i] = cvcoef[i] = 0.0;
+      denergy[i] = dbranch[i] = dcvcoef[i] = 0.0;
+      flag[i] = GammaGiven;
+      mpol[i] = 0;
+    }
+    ngamma = 0;
+    delcov();
+  }
+
+  void newcov(){
+    delcov();
+    bcov = new double [ngamma*ngamma];
+    for(int i=0 ; i<ngamma*ngamma ; i++) bcov[i] = 0.0;
+  }
+
+  void delcov(){
+    if(bcov != NULL){
+      delete [] bcov;
+      bcov = NULL;
     }
   }
 
   bool setGamma(double a, double b, double c){
     if(ngamma >= nsize-1) return false;
     else{
+      fstate[ngamma] = -1;
       energy[ngamma] = a;
       branch[ngamma] = b;
       cvcoef[ngamma] = c;
+      denergy[ngamma] = dbranch[ngamma] = dcvcoef[ngamma] = 0.0;
+      flag[ngamma] = GammaGiven;
+      mpol[ngamma] = 0;
       ngamma ++;
       return true;
     }
   }
 
+  bool setGamma(double a, double b, double c, double da, double db, double dc){
+    if(!setGamma(a,b,c)) return false;
+    denergy[ngamma-1] = (float)da;
+    dbranch[ngamma-1] = (float)db;
+    dcvcoef[ngamma-1] = (float)dc;
+    return true;
+  }
+
+  /* copy k-th gamma-ray to i-th, for removing lines */
+  void move(int i, int k){
+    fstate[i]  = fstate[k];
+    energy[i]  = energy[k];
+    branch[i]  = branch[k];
+    cvcoef[i]  = cvcoef[k];
+    denergy[i] = denergy[k];
+    dbranch[i] = dbranch[k];
+    dcvcoef[i] = dcvcoef[k];
+    flag[i]    = flag[k];
+    mpol[i]    = mpol[k];
+  }
+
+  /* number of G records only, data not decoded */
+  void setCount(int n){
+    ngamma = (n < nsize-1) ? n : nsize-1;
+  }
+
   int getNgamma(void){ return ngamma; }
   int getNsize(void){ return nsize; }
 
@@ -163,6 +339,36 @@ class Gamma{
     if(0 <= i && i < ngamma) c = cvcoef[i];
     return c;
   }
+
+  double getDenergy(int i){
+    double e = -1.0;
+    if(0 <= i && i < ngamma) e = denergy[i];
+    return e;
+  }
+
+  double getDbranch(int i){
+    double b = -1.0;
+    if(0 <= i && i < ngamma) b = dbranch[i];
+    return b;
+  }
+
+  double getDcvcoef(int i){
+    double c = -1.0;
+    if(0 <= i && i < ngamma) c = dcvcoef[i];
+    return c;
+  }
+
+  int getFlag(int i){
+    int f = -1;
+    if(0 <= i && i < ngamma) f = (int)flag[i];
+    return f;
+  }
+
+  double getCovariance(int i, int j){
+    double v = 0.0;
+    if((bcov != NULL) && (0 <= i && i < ngamma) && (0 <= j && j < ngamma)) v = bcov[i*ngamma + j];
+    return v;
+  }
 };
 
 
@@ -178,6 +384,8 @@ class ENSDF{
   double   ebase;     // energy unit, 1 for eV, 1000 for keV, etc.
  public:
   int      date;      // file created date
+  double   qval[QValueN];  // Q-values in Q record
+  bool     qgiven[QValueN];// true if the Q-value is given
   double   *energy;   // excitation energy in MeV
   double   *thalf;    // half-life in second
   int      *nspin;    // number of candidate spins
@@ -190,6 +398,10 @@ class ENSDF{
     nlevel = 0;
     ebase = 1.0;      // default energy unit = eV
     allocated = false;
+    for(int i=0 ; i<QValueN ; i++){
+      qval[i] = 0.0;
+      qgiven[i] = false;
+    }
   }
 
   ~ENSDF(){
@@ -241,6 +453,23 @@ class ENSDF{
     }
   }
 
+  /* reset levels used by the previous nuclide only */
+  void clear(){
+    for(int i=0 ; i<nlevel ; i++){
+      energy[i] = 0.0;
+      thalf[i]  = 0.0;
+      nspin[i]  = 0;
+      for(int j=0 ; j<Candidate_Spin ; j++) spin[i][j].init();
+      gamma[i].clear();
+    }
+    nlevel = 0;
+
+    for(int i=0 ; i<QValueN ; i++){
+      qval[i] = 0.0;
+      qgiven[i] = false;
+    }
+  }
+
   void setZA(unsigned int z, unsigned int a){
     za.setZA(z,a);
   }
@@ -288,11 +517,76 @@ class ENSDF{
 
 
 
+/**********************************************************/
+/*   Gamma-Ray Emission in Radioactive Decay              */
+/**********************************************************/
+class DecayGamma{
+ public:
+  unsigned int parent;    // Z*1000 + A of parent
+  unsigned int daughter;  // Z*1000 + A of daughter
+  int      mode;          // decay mode
+  double   elevel;        // parent level energy
+  double   energy;        // gamma-ray energy
+  double   intensity;     // photons per 100 decays of parent
+
+  DecayGamma(){
+    parent = daughter = 0;
+    mode = DecayUnknown;
+    elevel = energy = intensity = 0.0;
+  }
+};
+
+
+/**********************************************************/
+/*   Decay Gamma-Ray Library for Many Nuclides            */
+/**********************************************************/
+class DecayGammaLibrary{
+ private:
+  int      nsize;     // allocated memory size
+ public:
+  int      ngamma;    // number of gamma-rays stored
+  DecayGamma *gamma;  // gamma-ray emissions
+
+  DecayGammaLibrary(){
+    nsize = 0;
+    ngamma = 0;
+    gamma = NULL;
+  }
+
+  ~DecayGammaLibrary(){
+    if(gamma != NULL) delete [] gamma;
+  }
+
+  void add(DecayGamma g){
+    /* extend memory when full */
+    if(ngamma >= nsize){
+      int n = (nsize == 0) ? 1024 : nsize * 2;
+      DecayGamma *d = new DecayGamma [n];
+      for(int i=0 ; i<ngamma ; i++) d[i] = gamma[i];
+      if(gamma != NULL) delete [] gamma;
+      gamma = d;
+      nsize = n;
+    }
+    gamma[ngamma++] = g;
+  }
+};
+
+
 //------------------------------------------------------------------------------
 //     Prototype Definition
 
 // ensdfread.cpp
-int  ENSDFRead(ZAnumber, std::string, std::string, ENSDF *);
+int  ENSDFRead(ZAnumber, std::string, std::string, ENSDF *, const int, LevelCutoff);
+int  ENSDFListAdopted(std::string, std::string, ZAnumber *);
+int  ENSDFScanDataSet(const char *, const long, DataSet *);
+int  ENSDFStreamDataSet(const std::string, std::string *, DataSet **);
+int  ENSDFReadDecay(std::string, std::string, const double, DecayGammaLibrary *);
+
+// ensdfindex.cpp
+bool ENSDFIndexLookup(std::string, ZAnumber, const int, std::string *, DataSet *);
+
+// riplindex.cpp
+bool RIPLIndexLookup(std::string, ZAnumber, std::string *, RIPLBlock *);
 
 // riplread.cpp
 int  RIPLRead(std::string, ENSDF *);
@@ -0,0 +1,336 @@
+/******************************************************************************/
+/*  ensdfindex.cpp                                                            */
+/*        index of data set locations in ENSDF mass-chain files               */
+/******************************************************************************/
+
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+using namespace std;
+
+#include "cens.h"
+#include "terminate.h"
+#include "datafile.h"
+
+static const char   IndexMagic[] = "CENSIDX1";
+static const string IndexFile    = "ensdf.idx";
+static const int    FileNameLength = 32;
+
+/**********************************************************/
+/*   Index Entries                                        */
+/**********************************************************/
+class IndexFileEntry{
+ public:
+  char      name[FileNameLength]; // mass-chain file name, no directory
+  long long mtime;                // modification time stamp
+  long long size;                 // file size in bytes
+};
+
+class IndexDataEntry{
+ public:
+  unsigned int za;                // Z*1000 + A
+  int       type;                 // data set type
+  int       file;                 // index in file table
+  long long offset;               // byte offset of identification record
+  long long length;               // byte length of data set
+  char      dsid[31];             // data set identification
+};
+
+static bool   INDEXRefresh(string);
+static int    INDEXReadFile(string, IndexFileEntry **, IndexDataEntry **, int *);
+static void   INDEXWriteFile(string);
+static string INDEXFileName(string);
+static int    INDEXListChainFile(string, IndexFileEntry *);
+static int    INDEXScanChainFile(string, DataSet **);
+static int    INDEXCompare(const void *, const void *);
+static inline unsigned int INDEXza(ZAnumber za){ return za.getZ()*1000 + za.getA(); }
+
+static string         indexdir = "";      // directory of the index in memory
+static bool           indexready = false;
+static int            nfile = 0, ndata = 0;
+static IndexFileEntry *ftab = NULL;
+static IndexDataEntry *dtab = NULL;
+
+
+/***********************************************************/
+/*      Look for Data Set in Index                         */
+/***********************************************************/
+bool ENSDFIndexLookup(string ensdfdir, ZAnumber za, const int type, string *file, DataSet *ds)
+{
+  if(ensdfdir.length() == 0) ensdfdir = ".";
+
+  /* build or refresh the index once per run */
+  if(!indexready || (ensdfdir != indexdir)){
+    if(!INDEXRefresh(ensdfdir)) return false;
+  }
+
+  /* binary search, the table is sorted by ZA and type */
+  unsigned int key = INDEXza(za);
+  int i0 = 0, i1 = ndata;
+  while(i0 < i1){
+    int m = (i0 + i1) / 2;
+    if( (dtab[m].za < key) || ((dtab[m].za == key) && (dtab[m].type < type)) ) i0 = m + 1;
+    else i1 = m;
+  }
+  if((i0 >= ndata) || (dtab[i0].za != key) || (dtab[i0].type != type)) return false;
+
+  *file = ensdfdir + '/' + ftab[dtab[i0].file].name;
+  ds->za.setZA(za.getZ(),za.getA());
+  ds->type   = dtab[i0].type;
+  ds->offset = dtab[i0].offset;
+  ds->length = dtab[i0].length;
+  strncpy(ds->dsid,dtab[i0].dsid,31);
+
+  return true;
+}
+
+
+/***********************************************************/
+/*      Build Index, Rescan Modified Files Only            */
+/***********************************************************/
+bool INDEXRefresh(string dir)
+{
+  IndexFileEntry *ftab0 = NULL;
+  IndexDataEntry *dtab0 = NULL;
+  int nfile0 = 0, ndata0 = 0;
+
+  indexdir = dir;
+  indexready = false;
+  if(ftab != NULL){ delete [] ftab; ftab = NULL; }
+  if(dtab != NULL){ delete [] dtab; dtab = NULL; }
+  nfile = ndata = 0;
+
+  /* index previously saved */
+  nfile0 = INDEXReadFile(INDEXFileName(dir),&ftab0,&dtab0,&ndata0);
+
+  /* mass-chain files currently in the directory */
+  int nf = INDEXListChainFile(dir,NULL);
+  if(nf == 0){
+    if(ftab0 != NULL) delete [] ftab0;
+    if(dtab0 != NULL) delete [] dtab0;
+    return false;
+  }
+  ftab = new IndexFileEntry [nf];
+  nfile = INDEXListChainFile(dir,ftab);
+
+  /* check time stamps, count data sets */
+  int  *prev = new int [nfile];  // file index in the old table, -1 if changed
+  int  *nds  = new int [nfile];
+  DataSet **scan = new DataSet * [nfile]; // data sets of updated files
+  bool modified = (nfile != nfile0);
+  for(int i=0 ; i<nfile ; i++){
+    prev[i] = -1;
+    for(int k=0 ; k<nfile0 ; k++){
+      if( (strcmp(ftab[i].name,ftab0[k].name) == 0) && (ftab[i].mtime == ftab0[k].mtime) && (ftab[i].size == ftab0[k].size) ){
+        prev[i] = k;
+        break;
+      }
+    }
+
+    nds[i] = 0;
+    scan[i] = NULL;
+    if(prev[i] >= 0){
+      for(int j=0 ; j<ndata0 ; j++) if(dtab0[j].file == prev[i]) nds[i]++;
+    }
+    else{
+      nds[i] = INDEXScanChainFile(dir + '/' + ftab[i].name,&scan[i]);
+      modified = true;
+    }
+    ndata += nds[i];
+  }
+
+  /* copy unchanged entries, scan updated files */
+  dtab = new IndexDataEntry [ndata];
+  int n = 0;
+  for(int i=0 ; i<nfile ; i++){
+    if(prev[i] >= 0){
+      for(int j=0 ; j<ndata0 ; j++){
+        if(dtab0[j].file != prev[i]) continue;
+        dtab[n] = dtab0[j];
+        dtab[n++].file = i;
+      }
+    }
+    else{
+      for(int j=0 ; j<nds[i] ; j++){
+        memset(&dtab[n],0,sizeof(IndexDataEntry));
+        dtab[n].za     = INDEXza(scan[i][j].za);
+        dtab[n].type   = scan[i][j].type;
+        dtab[n].file   = i;
+        dtab[n].offset = scan[i][j].offset;
+        dtab[n].length = scan[i][j].length;
+        strncpy(dtab[n].dsid,scan[i][j].dsid,31);
+        n++;
+      }
+      if(scan[i] != NULL) delete [] scan[i];
+    }
+  }
+  ndata = n;
+
+  qsort(dtab,ndata,sizeof(IndexDataEntry),INDEXCompare);
+
+  if(modified){
+    message << "ENSDF data set index updated, " << nfile << " files " << ndata << " data sets";
+    Notice("ENSDFIndexLookup");
+    INDEXWriteFile(INDEXFileName(dir));
+  }
+
+  delete [] prev;
+  delete [] nds;
+  delete [] scan;
+  if(ftab0 != NULL) delete [] ftab0;
+  if(dtab0 != NULL) delete [] dtab0;
+
+  indexready = true;
+  return true;
+}
+
+
+/***********************************************************/
+/*      Index File in Directory, or Next to Tar Archive    */
+/***********************************************************/
+string INDEXFileName(string dir)
+{
+  string arc, mem;
+  if(TARPathSplit(dir,&arc,&mem) && (mem.length() == 0)) return arc + ".idx";
+
+  return dir + '/' + IndexFile;
+}
+
+
+/***********************************************************/
+/*      Read Index File                                    */
+/***********************************************************/
+int INDEXReadFile(string file, IndexFileEntry **ft, IndexDataEntry **dt, int *nd)
+{
+  FILE *fp = fopen(&file[0],"rb");
+  if(fp == NULL) return 0;
+
+  char magic[8];
+  int  n[4];
+  bool ok = (fread(magic,1,8,fp) == 8) && (memcmp(magic,IndexMagic,8) == 0)
+         && (fread(n,sizeof(int),4,fp) == 4)
+         && (n[2] == (int)sizeof(IndexFileEntry)) && (n[3] == (int)sizeof(IndexDataEntry));
+
+  int nf = 0;
+  if(ok){
+    nf  = n[0];
+    *nd = n[1];
+    *ft = new IndexFileEntry [nf];
+    *dt = new IndexDataEntry [*nd];
+    ok = ((int)fread(*ft,sizeof(IndexFileEntry),nf,fp) == nf)
+      && ((int)fread(*dt,sizeof(IndexDataEntry),*nd,fp) == *nd);
+    if(!ok){
+      delete [] *ft; *ft = NULL;
+      delete [] *dt; *dt = NULL;
+      nf = *nd = 0;
+    }
+  }
+  fclose(fp);
+
+  if(!ok){
+    message << "ENSDF index file " << file << " broken, rebuilt";
+    Notice("ENSDFIndexLookup");
+  }
+
+  return nf;
+}
+
+
+/***********************************************************/
+/*      Write Index File                                   */
+/***********************************************************/
+void INDEXWriteFile(string file)
+{
+  string tmp = file + ".tmp";
+
+  /* the directory may be read-only, then index is kept in memory only */
+  FILE *fp = fopen(&tmp[0],"wb");
+  if(fp == NULL){
+    message << "ENSDF index file " << file << " cannot be written";
+    Notice("ENSDFIndexLookup");
+    return;
+  }
+
+  int n[4] = {nfile, ndata, (int)sizeof(IndexFileEntry), (int)sizeof(IndexDataEntry)};
+  fwrite(IndexMagic,1,8,fp);
+  fwrite(n,sizeof(int),4,fp);
+  fwrite(ftab,sizeof(IndexFileEntry),nfile,fp);
+  fwrite(dtab,sizeof(IndexDataEntry),ndata,fp);
+  fclose(fp);
+
+  rename(&tmp[0],&file[0]);
+}
+
+
+/***********************************************************/
+/*      Mass-Chain Files ensdf.AAA in Directory            */
+/***********************************************************/
+int INDEXListChainFile(string dir, IndexFileEntry *ft)
+{
+  int nf = DATADirectoryList(dir,NULL,NULL,NULL);
+  if(nf == 0) return 0;
+
+  string    *name  = new string [nf];
+  long long *mtime = new long long [nf];
+  long long *size  = new long long [nf];
+  nf = DATADirectoryList(dir,name,mtime,size);
+
+  int n = 0;
+  for(int i=0 ; i<nf ; i++){
+    /* ensdf.AAA, ensdf.AAA.gz, or ensdf.AAA.xz */
+    const char *d = name[i].c_str();
+    if((strlen(d) < 9) || (strncmp(d,"ensdf.",6) != 0)) continue;
+    if(!isdigit(d[6]) || !isdigit(d[7]) || !isdigit(d[8])) continue;
+    if((strlen(d) != 9) && (strcmp(&d[9],".gz") != 0) && (strcmp(&d[9],".xz") != 0)) continue;
+
+    if(ft != NULL){
+      memset(&ft[n],0,sizeof(IndexFileEntry));
+      strcpy(ft[n].name,d);
+      ft[n].mtime = mtime[i];
+      ft[n].size  = size[i];
+    }
+    n++;
+  }
+
+  delete [] name;
+  delete [] mtime;
+  delete [] size;
+
+  return n;
+}
+
+
+/***********************************************************/
+/*      Scan All Data Sets in Mass-Chain File              */
+/***********************************************************/
+int INDEXScanChainFile(string file, DataSet **ds)
+{
+  /* offsets are given in decompressed data for compressed files */
+  string buf;
+  int nds = ENSDFStreamDataSet(file,&buf,ds);
+  if(nds < 0){
+    *ds = NULL;
+    return 0;
+  }
+
+  return nds;
+}
+
+
+/***********************************************************/
+/*      Sort Order: ZA, Type, then Location                */
+/***********************************************************/
+int INDEXCompare(const void *a, const void *b)
+{
+  const IndexDataEntry *x = (const IndexDataEntry *)a;
+  const IndexDataEntry *y = (const IndexDataEntry *)b;
+
+  if(x->za   != y->za  ) return (x->za   < y->za  ) ? -1 : 1;
+  if(x->type != y->type) return (x->type < y->type) ? -1 : 1;
+  if(x->file != y->file) return (x->file < y->file) ? -1 : 1;
+  if(x->offset != y->offset) return (x->offset < y->offset) ? -1 : 1;
+  return 0;
+}
@@ -7,6 +7,7 @@
 #include <iostream>
 #include <iomanip>
 #include <cmath>
+#include <unordered_map>
 
 using namespace std;
 
@@ -14,14 +15,32 @@ using namespace std;
 #include "terminate.h"
 #include "elements.h"
 #include "physicalconstant.h"
-
+#include "datafile.h"
+
+static string   ENSDFFileName(ZAnumber, string, string, bool *);
+static void     ENSDFLoadFile(const string);
+static void     ENSDFLoadRange(const string, DataSet *);
+static bool     ENSDFFindDataSet(ZAnumber, DataSet *);
+static int      ENSDFSplitRecord(DataSet *);
+static int      ENSDFDataSetType(const string);
+static inline bool ENSDFBlankRecord(const char *, const int);
+static bool     ENSDFScanNext(const char *, const long, const bool, long *, DataSet *);
 static int      ENSDFReadIdentification(const string);
 static ZAnumber ENSDFReadZA(const string);
 static int      ENSDFSeekNextRecord(const char, const int, const int);
+static int      ENSDFSeekNextRecord(const char, const char, const int, const int);
+static int      ENSDFDecayMode(const string);
+static bool     ENSDFParseNormalization(const int, const int, double *);
+static void     ENSDFParseQLine(const string, ENSDF *, const double);
 static void     ENSDFParseLevelLine(const string, ENSDF *, const double);
 static void     ENSDFParseGammaLine(const string, Gamma *, const double);
+static unsigned char ENSDFParseMultipolarity(const string);
+static int      ENSDFParseFinalLevel(const int, const int, unordered_map<string,int> *);
+static string   ENSDFTrim(const string);
 static int      ENSDFParseSpinParity(const string, int *, int *);
 static double   ENSDFParseHalfLife(const string);
+static double   ENSDFParseUncertainty(const string, const string);
+static bool     ENSDFLevelCutoff(const string, ENSDF *, LevelCutoff);
 
 static inline bool isNumeric(const char c)
 {
@@ -38,95 +57,118 @@ static void print(ENSDF *);
 
 static string *dbase;
 static int     nline = 0;
+static string  ensdfbuf = "";   // entire content of the last ENSDF file opened
+static string  ensdfname = "";  // name of the file in the buffer
+static DataSet *ensdfds = NULL; // data sets in the buffer
+static int     ensdfnds = 0;    // number of data sets
 
 /***********************************************************/
 /*      Read ENSDF                                         */
 /***********************************************************/
-int ENSDFRead(ZAnumber za, string ensdfdir, string libname, ENSDF *lib)
+int ENSDFRead(ZAnumber za, string ensdfdir, string libname, ENSDF *lib, const int field, LevelCutoff cut)
 {
-  ostringstream os;
-  ifstream      fp;
-  string        file, str;
+  bool   chain = false;
+  string file = ENSDFFileName(za,ensdfdir,libname,&chain);
 
-  /* if ZA number is given, look for the ENSDF file in the current directory */
-  if((za.getZ() > 0) && (za.getA() > 0)){
-    os << setw(3) << setfill('0') << za.getZ() << setw(3) << setfill('0') << za.getA();
-    file = os.str();
-    file = "ENSDF" + file + ".dat";
-  }
-  /* when file name is given */
-  else file = libname;
+  DataSet ds;
+  bool found = false;
 
-  /* when directory is given by config.dat and file name does not contain directory */
-  if((ensdfdir.length() > 0) && !strchr(libname.c_str(),'/')){
-    /* remove if dir name includes a slash at the end */
-    if(ensdfdir[ensdfdir.length() - 1] == '/') ensdfdir[ensdfdir.length() - 1] = '\0';
-    file = ensdfdir + '/' + file;
+  /* mass-chain file, seek the data set location in the index */
+  if(chain){
+    if(ENSDFIndexLookup(ensdfdir,za,DataSetAdopted,&file,&ds)){
+      ENSDFLoadRange(file,&ds);
+      found = true;
+    }
   }
 
   message << "ENSDF file name " << file;
   Notice("ENSDFRead");
 
-  fp.open(&file[0]);
-  if(!fp){
-    message << "ENSDF file " << file << " cannot open";
-    TerminateCode("ENSDFRead");
+  /* the whole file is read once, and kept for next nuclides */
+  if(!found){
+    ENSDFLoadFile(file);
+    /* locate adopted level data set for this nuclide */
+    found = ENSDFFindDataSet(za,&ds);
   }
 
-  /* scan the file length */
-  nline = 0;
-  while(!fp.eof()){
-    getline(fp,str);
-    if(str.length() > 0) nline ++;
+  if(!found){
+    message << "adopted levels for Z = " << za.getZ() << " A = " << za.getA();
+    message << " not found in " << file;
+    TerminateCode("ENSDFRead");
   }
-  message << "ENSDF file length " << nline << " lines";
-  Notice("ENSDFRead");
 
-  /* grab the entire ENSDF file */
-  dbase = new string [nline];
-
-  fp.clear();
-  fp.seekg(0,ios::beg);
-  for(int i=0 ; i<nline; i++){
-    getline(fp,str);
-    if(str.length() > 0) dbase[i] = str;
-  }
-  fp.close();
+  /* split the data set into 80-column records */
+  nline = ENSDFSplitRecord(&ds);
+  message << "ENSDF data set length " << nline << " lines";
+  Notice("ENSDFRead");
 
 
   /* read first line in ENSDF datafile */
   int c0 = 0; // main counter
-  if(lib->getZ() == 0){
-    ZAnumber za = ENSDFReadZA(dbase[c0]);
-    lib->setZA(za.getZ(),za.getA());
-  }
+  lib->setZA(ds.za.getZ(),ds.za.getA());
   lib->date = ENSDFReadIdentification(dbase[c0++]);
 
+  /* read Q record, given before the first L record */
+  if(field & ReadFieldQValue){
+    int cq = ENSDFSeekNextRecord('l',c0,nline);
+    cq = ENSDFSeekNextRecord('q',c0,(cq < 0) ? nline : cq);
+    if(cq > 0) ENSDFParseQLine(dbase[cq],lib,lib->getUnit());
+  }
+
   /* read L records */
   int *cl = new int [lib->getNsize() + 1]; // index of L record
+  unordered_map<string,int> flevel;        // level index for FL= energy string
+  bool stop = false;
   while(c0 < nline){
     c0 = ENSDFSeekNextRecord('l',c0,nline); if(c0 < 0) break;
     /* remember the current L card location */
-    cl[lib->getNlevel()] = c0;
+    int n = lib->getNlevel();
+    cl[n] = c0;
 
-    ENSDFParseLevelLine(dbase[c0++],lib,lib->getUnit());
+    /* the rest of data set is not read beyond the cutoff */
+    if(ENSDFLevelCutoff(dbase[c0],lib,cut)){ stop = true; break; }
+
+    ENSDFParseLevelLine(dbase[c0],lib,lib->getUnit());
+    if((field & ReadFieldGamma) && (lib->getNlevel() > n)) flevel.emplace(ENSDFTrim(dbase[c0].substr(9,10)),n);
+    c0++;
   }
   /* insert the last line */
-  cl[lib->getNlevel()] = nline;
+  if(!stop) cl[lib->getNlevel()] = nline;
 
   message << "total number of given levels " << lib->getNlevel();
+  if(stop) message << ", truncated at cutoff";
   Notice("ENSDFRead");
 
-  /* read G records */
-  for(int i = 1 ; i < lib->getNlevel()-1 ; i++){
+  /* read G records, those of the last level are closed by the next
+     L record when truncated, or by the end of data set */
+  for(int i = 1 ; i < lib->getNlevel() ; i++){
     /* look for G records between two L records */
     int p0 = cl[i];
     int p1 = cl[i+1];
 
     /* scan all gamma-rays between p0 and p1 */
-    while(p0 > 0){
-      p0 = ENSDFSeekNextRecord('g',p0,p1); if(p0 < 0) break;
-      ENSDFParseGammaLine(dbase[p0++],&lib->gamma[i],lib->getUnit());
+    if(field & ReadFieldGamma){
+      while(p0 > 0){
+        p0 = ENSDFSeekNextRecord('g',p0,p1); if(p0 < 0) break;
+        int n = lib->gamma[i].getNgamma();
+        ENSDFParseGammaLine(dbase[p0++],&lib->gamma[i],lib->getUnit());
+        if(lib->gamma[i].getNgamma() == n) continue;
+
+        /* final level given by FL= in continuation records,
+           only a lower level is accepted */
+        int k = ENSDFParseFinalLevel(p0,p1,&flevel);
+        if((0 <= k) && (k < i)) lib->gamma[i].fstate[n] = k;
+      }
+    }
+    /* count G records only */
+    else{
+      int ng = 0;
+      while(p0 > 0){
+        p0 = ENSDFSeekNextRecord('g',p0,p1); if(p0 < 0) break;
+        p0++;
+        ng++;
+      }
+      lib->gamma[i].setCount(ng);
     }
   }
 
@@ -141,6 +183,474 @@ int ENSDFRead(ZAnumber za, string ensdfdir, string libname, ENSDF *lib)
 }
 
 
+/***********************************************************/
+/*      List All Adopted Data Sets in ENSDF File           */
+/***********************************************************/
+int ENSDFListAdopted(string ensdfdir, string libname, ZAnumber *za)
+{
+  ZAnumber z0(0,0);
+  bool   chain = false;
+  string file = ENSDFFileName(z0,ensdfdir,libname,&chain);
+
+  ENSDFLoadFile(file);
+
+  int nds = ensdfnds;
+  DataSet *ds = ensdfds;
+
+  /* when ZA is NULL, just count them */
+  int n = 0;
+  for(int i=0 ; i<nds ; i++){
+    if(ds[i].type != DataSetAdopted) continue;
+    if(za != NULL) za[n] = ds[i].za;
+    n++;
+  }
+
+  /* a file containing only one data set, such as ENSDFZZZAAA.dat */
+  if((n == 0) && (nds == 1)){
+    if(za != NULL) za[n] = ds[0].za;
+    n++;
+  }
+
+  return n;
+}
+
+
+/***********************************************************/
+/*      Read All Decay Data Sets in ENSDF File             */
+/***********************************************************/
+int ENSDFReadDecay(string ensdfdir, string libname, const double u, DecayGammaLibrary *dlib)
+{
+  ZAnumber z0(0,0);
+  bool   chain = false;
+  string file = ENSDFFileName(z0,ensdfdir,libname,&chain);
+
+  message << "ENSDF file name " << file;
+  Notice("ENSDFReadDecay");
+
+  ENSDFLoadFile(file);
+
+  int nds = ensdfnds;
+  DataSet *ds = ensdfds;
+
+  int n0 = dlib->ngamma;
+  for(int i=0 ; i<nds ; i++){
+    if(ds[i].type != DataSetDecay) continue;
+
+    int mode = ENSDFDecayMode((string)ds[i].dsid);
+    if(mode == DecayUnknown) continue;
+
+    nline = ENSDFSplitRecord(&ds[i]);
+
+    /* parent nucleus and its level energy in P record */
+    DecayGamma dg;
+    int cp = ENSDFSeekNextRecord('p',1,nline);
+    if(cp < 0){
+      message << "parent record not found in " << ds[i].dsid;
+      Notice("ENSDFReadDecay");
+      delete [] dbase;
+      continue;
+    }
+    ZAnumber zp = ENSDFReadZA(dbase[cp]);
+    dg.parent   = zp.getZ()*1000 + zp.getA();
+    dg.daughter = ds[i].za.getZ()*1000 + ds[i].za.getA();
+    dg.mode     = mode;
+    bool numr = true;
+    for(int k=9 ; k<19 ; k++) if(!isNumeric(dbase[cp][k])) numr = false;
+    if(numr) dg.elevel = atof(dbase[cp].substr(9,10).c_str()) * 1e+3 / u;
+
+    /* factor to convert relative intensities into photons per 100 decays */
+    double f = 0.0;
+    if(!ENSDFParseNormalization(1,nline,&f)){
+      message << "no normalization given in " << ds[i].dsid;
+      Notice("ENSDFReadDecay");
+      delete [] dbase;
+      continue;
+    }
+
+    /* all G records, including those not placed in the level scheme */
+    int ng = 0;
+    for(int p=1 ; p>0 ; ){
+      p = ENSDFSeekNextRecord('g',p,nline); if(p < 0) break;
+      ng++; p++;
+    }
+
+    Gamma gam;
+    gam.memalloc(ng + 1);
+    for(int p=1 ; p>0 ; ){
+      p = ENSDFSeekNextRecord('g',p,nline); if(p < 0) break;
+      ENSDFParseGammaLine(dbase[p++],&gam,u);
+    }
+
+    for(int j=0 ; j<gam.getNgamma() ; j++){
+      if(gam.getBranch(j) <= 0.0) continue;
+      dg.energy    = gam.getEnergy(j);
+      dg.intensity = gam.getBranch(j) * f;
+      dlib->add(dg);
+    }
+
+    delete [] dbase;
+  }
+
+  return dlib->ngamma - n0;
+}
+
+
+/***********************************************************/
+/*      Decay Mode from DSID                               */
+/***********************************************************/
+int ENSDFDecayMode(const string dsid)
+{
+  int mode = DecayUnknown;
+
+  /* DSID starts with parent NUCID, like "60CO B- DECAY" */
+  size_t i0 = dsid.find(' ');
+  if(i0 == string::npos) return mode;
+  string d = dsid.substr(i0 + 1);
+
+  if(     d.find("B- DECAY") == 0) mode = DecayBetaMinus;
+  else if(d.find("EC DECAY") == 0) mode = DecayEC;
+  else if(d.find("B+ DECAY") == 0) mode = DecayEC;
+  else if(d.find("IT DECAY") == 0) mode = DecayIT;
+  else if(d.find("A DECAY")  == 0) mode = DecayAlpha;
+
+  return mode;
+}
+
+
+/***********************************************************/
+/*      Normalization Factor from N and PN Records         */
+/***********************************************************/
+bool ENSDFParseNormalization(const int p0, const int p1, double *f)
+{
+  /* PN record gives the product NR x BR */
+  int cn = ENSDFSeekNextRecord('p','n',p0,p1);
+  if(cn > 0){
+    string d = dbase[cn].substr(9,10);
+    if(d.find_first_not_of(' ') != string::npos){
+      *f = atof(d.c_str());
+      return true;
+    }
+  }
+
+  /* NR and BR in N record, BR = 1 if blank */
+  cn = ENSDFSeekNextRecord('n',p0,p1);
+  if(cn < 0) return false;
+
+  string nr = dbase[cn].substr( 9,10);
+  string br = dbase[cn].substr(31, 8);
+  if(nr.find_first_not_of(' ') == string::npos) return false;
+
+  *f = atof(nr.c_str());
+  if(br.find_first_not_of(' ') != string::npos) *f *= atof(br.c_str());
+
+  return true;
+}
+
+
+/***********************************************************/
+/*      ENSDF File Name from ZA or Given Name              */
+/***********************************************************/
+string ENSDFFileName(ZAnumber za, string ensdfdir, string libname, bool *chain)
+{
+  ostringstream os;
+  string        file;
+
+  /* remove if dir name includes a slash at the end */
+  if((ensdfdir.length() > 0) && (ensdfdir[ensdfdir.length() - 1] == '/')) ensdfdir.erase(ensdfdir.length() - 1);
+
+  /* when file name is given */
+  if(libname.length() > 0){
+    file = libname;
+    /* when directory is given by config.dat and file name does not contain directory */
+    if((ensdfdir.length() > 0) && !strchr(libname.c_str(),'/')) file = ensdfdir + '/' + file;
+  }
+
+  /* if ZA number is given, look for the ENSDFZZZAAA.dat file first,
+     then the mass-chain file ensdf.AAA as distributed by NNDC */
+  else if((za.getZ() > 0) && (za.getA() > 0)){
+    os << setw(3) << setfill('0') << za.getZ() << setw(3) << setfill('0') << za.getA();
+    file = "ENSDF" + os.str() + ".dat";
+    if(ensdfdir.length() > 0) file = ensdfdir + '/' + file;
+
+    /* compressed files, name.gz or name.xz, are also looked for */
+    string f = DATAFileFind(file);
+    if(DATAFileExist(f)) file = f;
+    else{
+      os.str("");
+      os << setw(3) << setfill('0') << za.getA();
+      file = "ensdf." + os.str();
+      if(ensdfdir.length() > 0) file = ensdfdir + '/' + file;
+      *chain = true;
+    }
+  }
+
+  return DATAFileFind(file);
+}
+
+
+/***********************************************************/
+/*      Read Entire File into Buffer                       */
+/***********************************************************/
+void ENSDFLoadFile(const string file)
+{
+  /* the same file is already in memory */
+  if(file == ensdfname) return;
+
+  /* one sequential read, decompressed if needed, and data set table
+     scanned once for all nuclides in the file */
+  if(ensdfds != NULL){
+    delete [] ensdfds;
+    ensdfds = NULL;
+  }
+  ensdfnds = ENSDFStreamDataSet(file,&ensdfbuf,&ensdfds);
+  if(ensdfnds < 0){
+    ensdfnds = 0;
+    message << "ENSDF file " << file << " cannot open";
+    TerminateCode("ENSDFRead");
+  }
+  long len = ensdfbuf.length();
+
+  ensdfname = file;
+
+  message << "ENSDF file length " << len << " bytes";
+  Notice("ENSDFRead");
+}
+
+
+/***********************************************************/
+/*      Read Part of File Given by Index                   */
+/***********************************************************/
+void ENSDFLoadRange(const string file, DataSet *ds)
+{
+  if(!DATAFileReadRange(file,ds->offset,ds->length,&ensdfbuf)){
+    message << "ENSDF file " << file << " cannot open, or changed after indexing";
+    TerminateCode("ENSDFRead");
+  }
+
+  /* buffer contains this data set only */
+  ds->offset = 0;
+  ensdfname = "";
+  if(ensdfds != NULL) delete [] ensdfds;
+  ensdfnds = 1;
+  ensdfds  = new DataSet [ensdfnds];
+  ensdfds[0] = *ds;
+
+  message << "ENSDF data set read from index " << ds->length << " bytes";
+  Notice("ENSDFRead");
+}
+
+
+/***********************************************************/
+/*      Locate Data Sets in Buffer                         */
+/***********************************************************/
+int ENSDFScanDataSet(const char *buf, const long len, DataSet *ds)
+{
+  long p = 0;
+  int  n = 0;
+  DataSet d;
+
+  while(ENSDFScanNext(buf,len,true,&p,&d)){
+    if(ds != NULL) ds[n] = d;
+    n++;
+  }
+
+  return n;
+}
+
+
+/***********************************************************/
+/*      Read File and Locate Data Sets Block by Block      */
+/***********************************************************/
+/* data sets are located in each block as soon as it is decompressed,
+   while the next block is being decompressed in the background. The
+   data set table is allocated here. The number of data sets is
+   returned, or -1 if the file cannot open. */
+int ENSDFStreamDataSet(const string file, string *buf, DataSet **dsp)
+{
+  DataStream st;
+  if(!st.open(file)) return -1;
+
+  buf->clear();
+  int nds = 0, nmax = 64;
+  DataSet *ds = new DataSet [nmax];
+
+  long m = 0, p = 0;
+  bool eof = false;
+  while(!eof){
+    buf->resize(m + DataBlockSize);
+    long k = st.read(&(*buf)[m],DataBlockSize);
+    m += k;
+    buf->resize(m);
+    eof = (k < DataBlockSize);
+
+    /* data sets closed by the end record in the data read so far */
+    DataSet d;
+    while(ENSDFScanNext(buf->c_str(),m,eof,&p,&d)){
+      if(nds == nmax){
+        DataSet *t = new DataSet [2*nmax];
+        for(int i=0 ; i<nds ; i++) t[i] = ds[i];
+        delete [] ds;
+        ds = t;
+        nmax *= 2;
+      }
+      ds[nds++] = d;
+    }
+  }
+  st.close();
+
+  *dsp = ds;
+  return nds;
+}
+
+
+/***********************************************************/
+/*      Locate Next Data Set from Position                 */
+/***********************************************************/
+/* false if no data set follows, or the data set is not closed by the
+   end record before len, unless the data are complete (eof). The
+   position is moved to the end record, or to the incomplete data set */
+bool ENSDFScanNext(const char *buf, const long len, const bool eof, long *pos, DataSet *ds)
+{
+  long p = *pos;
+
+  /* blank records between data sets */
+  const char *q = NULL;
+  long r = 0;
+  while(true){
+    if(p >= len){ *pos = p; return false; }
+    q = (const char *)memchr(buf + p,'\n',len - p);
+    if((q == NULL) && !eof){ *pos = p; return false; }
+    r = (q == NULL) ? len : q - buf + 1; // beginning of next record
+    if(!ENSDFBlankRecord(buf + p, r - p)) break;
+    p = r;
+  }
+  *pos = p;
+
+  /* identification record, first record of a data set */
+  long p0 = p;
+  string id(buf + p, r - p);
+  if(id.length() < (unsigned int)Record_Length) id.resize(Record_Length,' ');
+
+  /* move to the end record, which is blank */
+  p = r;
+  while(true){
+    if(p >= len){
+      if(!eof) return false;
+      break;
+    }
+    q = (const char *)memchr(buf + p,'\n',len - p);
+    if((q == NULL) && !eof) return false;
+    r = (q == NULL) ? len : q - buf + 1;
+    if(ENSDFBlankRecord(buf + p, r - p)) break;
+    p = r;
+  }
+
+  ds->za     = ENSDFReadZA(id);
+  ds->type   = ENSDFDataSetType(id);
+  ds->offset = p0;
+  ds->length = p - p0;
+  strncpy(ds->dsid,id.substr(9,30).c_str(),30);
+  ds->dsid[30] = '\0';
+
+  *pos = p;
+  return true;
+}
+
+
+/***********************************************************/
+/*      Find Adopted Level Data Set for Given ZA           */
+/***********************************************************/
+bool ENSDFFindDataSet(ZAnumber za, DataSet *dsfound)
+{
+  int nds = ensdfnds;
+  DataSet *ds = ensdfds;
+  if(nds == 0) return false;
+
+  bool found = false;
+  for(int i=0 ; i<nds ; i++){
+    if(ds[i].type != DataSetAdopted) continue;
+    /* first adopted data set if ZA is not given */
+    if( ((za.getZ() == 0) && (za.getA() == 0)) || (ds[i].za == za) ){
+      *dsfound = ds[i];
+      found = true;
+      break;
+    }
+  }
+
+  /* a file containing only one data set, such as ENSDFZZZAAA.dat */
+  if(!found && (nds == 1)){
+    *dsfound = ds[0];
+    found = true;
+  }
+
+  return found;
+}
+
+
+/***********************************************************/
+/*      Split Data Set into Records                        */
+/***********************************************************/
+int ENSDFSplitRecord(DataSet *ds)
+{
+  const char *buf = ensdfbuf.c_str() + ds->offset;
+  long len = ds->length;
+
+  /* count records */
+  int n = 0;
+  for(long p=0 ; p<len ; p++) if(buf[p] == '\n') n++;
+  if((len > 0) && (buf[len-1] != '\n')) n++;
+
+  dbase = new string [n];
+
+  /* copy records, short records are padded to 80 columns */
+  long p = 0;
+  int  k = 0;
+  while((p < len) && (k < n)){
+    const char *q = (const char *)memchr(buf + p,'\n',len - p);
+    long r = (q == NULL) ? len : q - buf;
+
+    long m = r - p;
+    if((m > 0) && (buf[r-1] == '\r')) m--;
+    dbase[k].assign(buf + p, m);
+    if(dbase[k].length() < (unsigned int)Record_Length) dbase[k].resize(Record_Length,' ');
+
+    k++;
+    p = r + 1;
+  }
+
+  return k;
+}
+
+
+/***********************************************************/
+/*      Data Set Type from DSID                            */
+/***********************************************************/
+int ENSDFDataSetType(const string s)
+{
+  string dsid = s.substr(9,30);
+
+  int type = DataSetReaction;
+  if(     dsid.find("ADOPTED LEVELS") == 0) type = DataSetAdopted;
+  else if(dsid.find(" DECAY")  != string::npos) type = DataSetDecay;
+  else if(dsid.find("COMMENTS")   == 0) type = DataSetOther;
+  else if(dsid.find("REFERENCES") == 0) type = DataSetOther;
+
+  return type;
+}
+
+
+/***********************************************************/
+/*      Blank (End) Record                                 */
+/***********************************************************/
+static inline bool ENSDFBlankRecord(const char *s, const int n)
+{
+  for(int i=0 ; i<n ; i++){
+    if((s[i] != ' ') && (s[i] != '\n') && (s[i] != '\r')) return false;
+  }
+  return true;
+}
+
+
 /***********************************************************/
 /*      First Line (Header) in ENSDF                       */
 /***********************************************************/
@@ -183,10 +693,16 @@ ZAnumber ENSDFReadZA(const string s)
 /*      Move to L or G Card in Database                    */
 /***********************************************************/
 int ENSDFSeekNextRecord(const char c, const int p0, const int p1)
+{
+  return ENSDFSeekNextRecord(' ',c,p0,p1);
+}
+
+/* column 7 is given too, such as 'p' for PN record */
+int ENSDFSeekNextRecord(const char d, const char c, const int p0, const int p1)
 {
   int p = 0;
   for(p=p0 ; p<p1 ; p++){
-    string str = dbase[p];
+    const string &str = dbase[p];
 
     char c5 = tolower(str[5]);
     char c6 = tolower(str[6]);
@@ -194,13 +710,36 @@ int ENSDFSeekNextRecord(const char c, const int p0, const int p1)
 
     if(c5 != ' ') continue;
     if(c6 == 'c' || c7 == 'd') continue;
-    if(c6 == ' ' && c7 == c) break;
+    if(c6 == d && c7 == c) break;
   }
   if(p >= p1) return -1;
   else return p;
 }
 
 
+/***********************************************************/
+/*      Parse Q Record in ENSDF                            */
+/***********************************************************/
+void ENSDFParseQLine(const string line, ENSDF *lib, const double u)
+{
+  /* Q-, SN, SP, and QA fields, given in keV */
+  const int col[QValueN] = {9, 21, 31, 41};
+  const int len[QValueN] = {10, 8, 8, 8};
+
+  for(int k=0 ; k<QValueN ; k++){
+    bool blnk = true, numr = true;
+    for(int i=col[k] ; i<col[k]+len[k] ; i++){
+      if(line[i] != ' ') blnk = false;
+      if(!isNumeric(line[i])) numr = false;
+    }
+    if(blnk || !numr) continue;
+
+    lib->qval[k]   = atof(line.substr(col[k],len[k]).c_str()) * 1e+3 / u;
+    lib->qgiven[k] = true;
+  }
+}
+
+
 /***********************************************************/
 /*      Parse L Record in ENSDF                            */
 /***********************************************************/
@@ -225,22 +764,145 @@ void ENSDFParseLevelLine(const string line, ENSDF *lib, const double u)
 }
 
 
+/***********************************************************/
+/*      Check Level Number and Energy Cutoff               */
+/***********************************************************/
+bool ENSDFLevelCutoff(const string line, ENSDF *lib, LevelCutoff cut)
+{
+  if((cut.nmax > 0) && (lib->getNlevel() >= cut.nmax)) return true;
+
+  if(cut.emax > 0.0){
+    /* levels like 0+X are not cut */
+    for(int i=9 ; i<19 ; i++) if(!isNumeric(line[i])) return false;
+    double e = atof(line.substr( 9,10).c_str()) * 1e+3 / lib->getUnit();
+    if(e > cut.emax) return true;
+  }
+
+  return false;
+}
+
+
 /***********************************************************/
 /*      Parse G Record in ENSDF                            */
 /***********************************************************/
 void ENSDFParseGammaLine(const string line, Gamma *gam, const double u)
 {
-  /* gamma-ray energy */
-  double g = atof(line.substr( 9,10).c_str()) * 1e+3 / u;
+  /* gamma-ray energy, DE in column 20-21 */
+  double g  = atof(line.substr( 9,10).c_str()) * 1e+3 / u;
+  double dg = ENSDFParseUncertainty(line.substr( 9,10),line.substr(19,2)) * 1e+3 / u;
 
-  /* gamma-ray intensity */
-  double r = atof(line.substr(21, 8).c_str());
+  /* gamma-ray intensity, DRI in column 30-31 */
+  double r  = atof(line.substr(21, 8).c_str());
+  double dr = ENSDFParseUncertainty(line.substr(21, 8),line.substr(29,2));
 
-  /* conversion coefficient */
-  double c = atof(line.substr(55, 7).c_str());
+  /* conversion coefficient, DCC in column 63-64 */
+  double c  = atof(line.substr(55, 7).c_str());
+  double dc = ENSDFParseUncertainty(line.substr(55, 7),line.substr(62,2));
 
   /* copy data to object */
-  gam->setGamma(g,r,c);
+  if(!gam->setGamma(g,r,c,dg,dr,dc)) return;
+
+  /* multipolarity in column 32-41 */
+  gam->mpol[gam->getNgamma()-1] = ENSDFParseMultipolarity(line.substr(31,10));
+}
+
+
+/***********************************************************/
+/*      Multipolarity Code from MUL Field                  */
+/***********************************************************/
+/* the leading component is taken, such as M1 of M1+E2, brackets and
+   parentheses for assumed or uncertain values are ignored, D and Q
+   give L without the character, and E0 is not coded */
+unsigned char ENSDFParseMultipolarity(const string mul)
+{
+  for(unsigned int i=0 ; i<mul.length() ; i++){
+    char c = toupper(mul[i]);
+    if(c == ' ' || c == '[' || c == '(') continue;
+
+    if(c == 'D') return 1*4 + MultipolUnknown;
+    if(c == 'Q') return 2*4 + MultipolUnknown;
+    if((c == 'E' || c == 'M') && (i+1 < mul.length())){
+      int l = mul[i+1] - '0';
+      if(l < 1 || l > 9) break;
+      return l*4 + ((c == 'E') ? MultipolElectric : MultipolMagnetic);
+    }
+    break;
+  }
+  return 0;
+}
+
+
+/***********************************************************/
+/*      Final Level Given by FL= in G Continuation         */
+/***********************************************************/
+/* continuation records follow the G record, comments may be
+   interleaved, and the value is the energy field of the L record */
+int ENSDFParseFinalLevel(const int p0, const int p1, unordered_map<string,int> *flevel)
+{
+  for(int p=p0 ; p<p1 ; p++){
+    const string &str = dbase[p];
+
+    char c6 = tolower(str[6]);
+    char c7 = tolower(str[7]);
+
+    if(c6 == 'c' || c6 == 'd' || c6 == 't') continue;
+    if(str[5] == ' ' || c7 != 'g') break;
+
+    size_t i = str.find("FL=",9);
+    if(i == string::npos) continue;
+    if((i > 9) && (str[i-1] != ' ') && (str[i-1] != '$')) continue;
+
+    size_t j = str.find('$',i);
+    string e = str.substr(i+3,(j == string::npos) ? string::npos : j-i-3);
+    unordered_map<string,int>::iterator it = flevel->find(ENSDFTrim(e));
+
+    /* FL=? or the energy not in the L records */
+    return (it == flevel->end()) ? -1 : it->second;
+  }
+  return -1;
+}
+
+
+/***********************************************************/
+/*      Remove Leading and Trailing Blanks                 */
+/***********************************************************/
+string ENSDFTrim(const string s)
+{
+  size_t i0 = s.find_first_not_of(' ');
+  if(i0 == string::npos) return "";
+  size_t i1 = s.find_last_not_of(' ');
+
+  return s.substr(i0,i1-i0+1);
+}
+
+
+/***********************************************************/
+/*      Uncertainty Given in Units of the Last Digit       */
+/***********************************************************/
+double ENSDFParseUncertainty(const string val, const string unc)
+{
+  /* LT, GT, AP, CA, SY, and asymmetric ones are not taken */
+  size_t u0 = unc.find_first_not_of(' ');
+  if(u0 == string::npos) return 0.0;
+  size_t u1 = unc.find_last_not_of(' ');
+  for(size_t i=u0 ; i<=u1 ; i++) if(!isdigit(unc[i])) return 0.0;
+
+  size_t v0 = val.find_first_not_of(' ');
+  if(v0 == string::npos) return 0.0;
+  size_t v1 = val.find_last_not_of(' ');
+  string v = val.substr(v0,v1 - v0 + 1);
+
+  /* decimal places of mantissa, and exponent like 1.2E-3 */
+  int    ex = 0;
+  size_t e = v.find_first_of("Ee");
+  if(e != string::npos){
+    ex = atoi(v.c_str() + e + 1);
+    v.erase(e);
+  }
+  size_t p = v.find('.');
+  int nd = (p == string::npos) ? 0 : (int)(v.length() - p - 1);
+
+  return atof(unc.c_str()) * pow(10.0,(double)(ex - nd));
 }
 
 
@@ -0,0 +1,82 @@
+/******************************************************************************/
+/*  outbateman.cpp                                                            */
+/*        print time-dependent populations of long-lived states               */
+/******************************************************************************/
+
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+#include "cens.h"
+
+
+/**********************************************************/
+/*      Print Populations and Emission Rates              */
+/**********************************************************/
+/* blocks are separated by two blank lines for plotting, and the
+   population and rate blocks are repeated for each entry distribution */
+void OUTBateman(DecayMatrix *dm, IsomerPopulation *ip)
+{
+  const int ns = ip->nstate;
+  const int nt = ip->ntime;
+  const int ne = ip->nrhs;
+
+  cout << "# ";
+  cout << setw(5) << dm->z;
+  cout << setw(5) << dm->a;
+  cout << setw(7) << ns;
+  cout << setw(7) << nt;
+  if(ne > 1) cout << setw(7) << ne;
+  cout << endl;
+
+  /* initial populations of all distributions in columns */
+  cout << "# Long-Lived State" << endl;
+  for(int s=0 ; s<ns ; s++){
+    int i = ip->level[s];
+    cout << setw(5) << i+1;
+    cout << setprecision(5) << setw(13) << dm->energy[i];
+    cout << setprecision(4) << setw(12) << dm->thalf[i];
+    for(int r=0 ; r<ne ; r++) cout << setprecision(4) << setw(12) << ip->initial[s*ne + r];
+    cout << endl;
+  }
+  cout << endl;
+  cout << endl;
+
+  for(int r=0 ; r<ne ; r++){
+    /* time in rows, states in columns */
+    cout << "# Population";
+    if(ne > 1) cout << " " << r+1;
+    cout << endl;
+    for(int t=0 ; t<nt ; t++){
+      cout << setprecision(4) << setw(12) << ip->time[t];
+      for(int s=0 ; s<ns ; s++) cout << setprecision(4) << setw(12) << ip->population[(r*nt + t)*ns + s];
+      cout << endl;
+    }
+    cout << endl;
+    cout << endl;
+
+    /* gamma-rays in rows, time in columns, only those emitted */
+    cout << "# Gamma-Ray Emission Rate";
+    if(ne > 1) cout << " " << r+1;
+    cout << endl;
+    double *rate = &ip->rate[r*dm->ngamma*nt];
+    for(int i=0 ; i<dm->nlevel ; i++){
+      for(int k=dm->offset[i] ; k<dm->offset[i+1] ; k++){
+        bool emit = false;
+        for(int t=0 ; t<nt ; t++) if(rate[k*nt + t] > 0.0) emit = true;
+        if(!emit) continue;
+
+        cout << setw(5) << i+1;
+        cout << setw(5) << dm->fstate[k]+1;
+        cout << setprecision(5) << setw(13) << dm->energy[i] - dm->energy[dm->fstate[k]];
+        for(int t=0 ; t<nt ; t++) cout << setprecision(4) << setw(12) << rate[k*nt + t];
+        cout << endl;
+      }
+    }
+    if(r < ne-1){
+      cout << endl;
+      cout << endl;
+    }
+  }
+}
@@ -0,0 +1,66 @@
+/******************************************************************************/
+/*  outcascade.cpp                                                            */
+/*        print level populations and gamma-ray intensities in cascade        */
+/******************************************************************************/
+
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+#include "cens.h"
+
+
+/**********************************************************/
+/*      Print Cascade Results                             */
+/**********************************************************/
+/* one column for each entry distribution, blocks are separated
+   by two blank lines for plotting */
+void OUTCascade(DecayMatrix *dm, CascadePopulation *cp)
+{
+  const int nr = cp->nrhs;
+
+  cout << "# ";
+  cout << setw(5) << dm->z;
+  cout << setw(5) << dm->a;
+  cout << setw(7) << dm->nlevel;
+  cout << setw(7) << dm->ngamma;
+  cout << setw(7) << nr << endl;
+
+  cout << "# Level Population" << endl;
+  for(int i=0 ; i<dm->nlevel ; i++){
+    cout << setw(5) << i+1;
+    cout << setprecision(5) << setw(13) << dm->energy[i];
+    for(int r=0 ; r<nr ; r++) cout << setprecision(4) << setw(12) << cp->population[i*nr + r];
+    cout << endl;
+  }
+  cout << endl;
+  cout << endl;
+
+  cout << "# Gamma-Ray Intensity" << endl;
+  for(int i=0 ; i<dm->nlevel ; i++){
+    for(int k=dm->offset[i] ; k<dm->offset[i+1] ; k++){
+      cout << setw(5) << i+1;
+      cout << setw(5) << dm->fstate[k]+1;
+      cout << setprecision(5) << setw(13) << dm->energy[i] - dm->energy[dm->fstate[k]];
+      for(int r=0 ; r<nr ; r++) cout << setprecision(4) << setw(12) << cp->intensity[k*nr + r];
+      cout << endl;
+    }
+  }
+  cout << endl;
+  cout << endl;
+
+  /* ground state, isomers, and levels without decay */
+  cout << "# Terminal Feeding" << endl;
+  for(int i=0 ; i<dm->nlevel ; i++){
+    bool fed = false;
+    for(int r=0 ; r<nr ; r++) if(cp->feeding[i*nr + r] != 0.0) fed = true;
+    if(!fed) continue;
+
+    cout << setw(5) << i+1;
+    cout << setprecision(5) << setw(13) << dm->energy[i];
+    cout << setprecision(2) << setw(10) << dm->thalf[i];
+    for(int r=0 ; r<nr ; r++) cout << setprecision(4) << setw(12) << cp->feeding[i*nr + r];
+    cout << endl;
+  }
+}
@@ -0,0 +1,87 @@
+/******************************************************************************/
+/*  outcheck.cpp                                                              */
+/*        print results of level scheme check                                 */
+/******************************************************************************/
+
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+#include "cens.h"
+
+static string itemname[CheckItems] = {
+  "EnergyMismatch", "GammaOrder", "LevelOrder", "NoGamma",
+  "Unreached", "NoBranch", "PartialBranch", "Doublet"};
+
+
+/**********************************************************/
+/*      Column Names of Nuclide Lines                     */
+/**********************************************************/
+void OUTCheckHeader()
+{
+  cout << "#NUCLIDE    Z    A levels gammas";
+  for(int i=0 ; i<CheckItems ; i++) cout << setw(6) << ("C" + to_string(i));
+  cout << "       Dmax" << endl;
+  for(int i=0 ; i<CheckItems ; i++) cout << "#  C" << i << " " << itemname[i] << endl;
+}
+
+
+/**********************************************************/
+/*      Print Check Results of One Nuclide                */
+/**********************************************************/
+/* one line per nuclide, Z, A, levels, gammas, counts of all
+   the items, and the largest energy deviation */
+void OUTCheckNuclide(ENSDF *lib, CheckReport *chk)
+{
+  cout << "NUCLIDE ";
+  cout << setw(5) << lib->getZ();
+  cout << setw(5) << lib->getA();
+  cout << setw(7) << chk->nlevel;
+  cout << setw(7) << chk->ngamma;
+  for(int i=0 ; i<CheckItems ; i++) cout << setw(6) << chk->count[i];
+  cout << setprecision(3) << setw(11) << chk->dmax << endl;
+}
+
+
+/**********************************************************/
+/*      Print Aggregated Results                          */
+/**********************************************************/
+void OUTCheckSummary(CheckReport *chk)
+{
+  cout << "TOTAL   ";
+  cout << setw(7) << chk->nnuclide;
+  cout << setw(10) << chk->nlevel;
+  cout << setw(10) << chk->ngamma << endl;
+
+  for(int i=0 ; i<CheckItems ; i++){
+    cout << "COUNT   " << setw(16) << left << itemname[i] << right;
+    cout << setw(10) << chk->count[i] << endl;
+  }
+
+  /* lower edge of decade, the first bin is from zero */
+  double b = 0.0;
+  for(int i=0 ; i<CheckHistogram ; i++){
+    cout << "DEVIATION ";
+    cout << setprecision(1) << setw(9) << b;
+    cout << setw(10) << chk->deviation[i] << endl;
+    b = (i == 0) ? 1e-6 : b * 10.0;
+  }
+
+  /* the last bin includes all higher multiplicities */
+  for(int i=0 ; i<CheckHistogram ; i++){
+    cout << "MULTIPLICITY ";
+    cout << setw(3) << i;
+    cout << setw(10) << chk->multiplicity[i] << endl;
+  }
+
+  for(int i=0 ; i<chk->nworst ; i++){
+    cout << "WORST   ";
+    cout << setw(5) << chk->worst[i].z;
+    cout << setw(5) << chk->worst[i].a;
+    cout << setw(7) << chk->worst[i].level;
+    cout << setprecision(5) << setw(13) << chk->worst[i].energy;
+    cout << setprecision(5) << setw(13) << chk->worst[i].egamma;
+    cout << setprecision(3) << setw(11) << chk->worst[i].delta << endl;
+  }
+}
@@ -0,0 +1,44 @@
+/******************************************************************************/
+/*  outcoinc.cpp                                                              */
+/*        print gamma-gamma coincidence list                                  */
+/******************************************************************************/
+
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+#include "cens.h"
+
+
+/**********************************************************/
+/*      Print Sparse Coincidence List                     */
+/**********************************************************/
+/* only ordered pairs are printed, E1 is the preceding gamma-ray and
+   E2 the following one, for the first entry distribution */
+void OUTCoincidence(DecayMatrix *dm, CoincidenceList *cl)
+{
+  cout << "# ";
+  cout << setw(5) << dm->z;
+  cout << setw(5) << dm->a;
+  cout << setw(7) << dm->nlevel;
+  cout << setw(7) << dm->ngamma;
+  cout << setw(10) << cl->n << endl;
+  cout << "#          E1           E2    Intensity" << endl;
+
+  /* initial level of each gamma-ray */
+  int *initial = new int [(dm->ngamma > 0) ? dm->ngamma : 1];
+  for(int i=0 ; i<dm->nlevel ; i++){
+    for(int k=dm->offset[i] ; k<dm->offset[i+1] ; k++) initial[k] = i;
+  }
+
+  for(int n=0 ; n<cl->n ; n++){
+    int a = cl->first[n];
+    int b = cl->second[n];
+    cout << setprecision(5) << setw(13) << dm->energy[initial[a]] - dm->energy[dm->fstate[a]];
+    cout << setprecision(5) << setw(13) << dm->energy[initial[b]] - dm->energy[dm->fstate[b]];
+    cout << setprecision(4) << setw(12) << cl->intensity[n] << endl;
+  }
+
+  delete [] initial;
+}
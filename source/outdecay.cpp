@@ -0,0 +1,81 @@
+/******************************************************************************/
+/*  outdecay.cpp                                                              */
+/*        write gamma-ray emission library for radioactive decay              */
+/******************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+
+using namespace std;
+
+#include "cens.h"
+#include "terminate.h"
+#include "binwrite.h"
+
+static int DecayGammaCompare(const void *, const void *);
+
+static const char DecayGammaMagic[] = "CENSDGL1";
+
+
+/**********************************************************/
+/*      Write Decay Gamma Library in Binary               */
+/**********************************************************/
+/* little-endian, 8-byte aligned
+     header   char[8]  magic "CENSDGL1"
+              uint32   number of gamma-rays
+              uint32   reserved
+              double   energy unit in eV
+     record   uint32   parent   Z*1000 + A
+              uint32   daughter Z*1000 + A
+              int32    decay mode, 1: B-, 2: EC/B+, 3: IT, 4: alpha
+              float    parent level energy
+              double   gamma-ray energy
+              double   photons per 100 decays of parent
+   records are sorted by parent, parent level, decay mode, and
+   gamma-ray energy */
+void OUTFdecay(string libname, const double u, DecayGammaLibrary *dlib)
+{
+  qsort(dlib->gamma,dlib->ngamma,sizeof(DecayGamma),DecayGammaCompare);
+
+  ofstream fp;
+  fp.open(&libname[0],ios::out | ios::binary);
+  if(!fp){
+    message << "decay gamma library " << libname << " cannot open";
+    TerminateCode("OUTFdecay");
+  }
+
+  fp.write(DecayGammaMagic,8);
+  BINWriteUInt32(fp,dlib->ngamma);
+  BINWriteUInt32(fp,0);
+  BINWriteDouble(fp,u);
+
+  for(int i=0 ; i<dlib->ngamma ; i++){
+    BINWriteUInt32(fp,dlib->gamma[i].parent);
+    BINWriteUInt32(fp,dlib->gamma[i].daughter);
+    BINWriteInt32(fp,dlib->gamma[i].mode);
+    BINWriteFloat(fp,(float)dlib->gamma[i].elevel);
+    BINWriteDouble(fp,dlib->gamma[i].energy);
+    BINWriteDouble(fp,dlib->gamma[i].intensity);
+  }
+  fp.close();
+
+  message << "decay gamma library " << libname << " " << dlib->ngamma << " gamma-rays";
+  Notice("OUTFdecay");
+}
+
+
+/**********************************************************/
+/*      Sort Order                                        */
+/**********************************************************/
+int DecayGammaCompare(const void *a, const void *b)
+{
+  const DecayGamma *x = (const DecayGamma *)a;
+  const DecayGamma *y = (const DecayGamma *)b;
+
+  if(x->parent != y->parent) return (x->parent < y->parent) ? -1 : 1;
+  if(x->elevel != y->elevel) return (x->elevel < y->elevel) ? -1 : 1;
+  if(x->mode   != y->mode  ) return (x->mode   < y->mode  ) ? -1 : 1;
+  if(x->energy != y->energy) return (x->energy < y->energy) ? -1 : 1;
+  return 0;
+}
@@ -0,0 +1,107 @@
+/******************************************************************************/
+/*  outmatrix.cpp                                                             */
+/*        write level-to-level decay matrices in binary CSR form              */
+/******************************************************************************/
+
+#include <iostream>
+#include <fstream>
+
+using namespace std;
+
+#include "cens.h"
+#include "terminate.h"
+#include "binwrite.h"
+
+static const char DecayMatrixMagic[] = "CENSCSR1";
+
+static ofstream matfp;
+static string   matname = "";
+static int      nmatrix = 0;
+
+
+/**********************************************************/
+/*      Open Decay Matrix File                            */
+/**********************************************************/
+/* little-endian, all arrays 8-byte aligned, so that the file
+   can be mapped into memory and used without parsing
+     header   char[8]  magic "CENSCSR1"
+              uint32   number of nuclides
+              uint32   reserved
+              double   energy unit in eV
+   for each nuclide
+     block    uint32   Z*1000 + A
+              uint32   number of levels, N
+              uint32   number of gamma-rays, M
+              uint32   reserved
+              uint64   byte length of this block, including this header
+              double   level energy [N]
+              double   half-life in sec, negative for stable, 0 if not given [N]
+              int32    spin doubled, -1 for unknown [N]
+              int32    parity +1, -1, or 0 for unknown [N]
+              uint32   first gamma-ray of each level [N+1]
+              uint32   final level index [M]
+              uint32   padding to 8-byte boundary, if N+1+M is odd
+              double   photon branching ratio, branch / (1 + ICC) [M]
+              double   total branching ratio [M] */
+void OUTMatrixOpen(string libname, const double u)
+{
+  matname = libname;
+  nmatrix = 0;
+
+  matfp.open(&matname[0],ios::out | ios::binary);
+  if(!matfp){
+    message << "decay matrix file " << matname << " cannot open";
+    TerminateCode("OUTMatrixOpen");
+  }
+
+  /* number of nuclides is rewritten when closed */
+  matfp.write(DecayMatrixMagic,8);
+  BINWriteUInt32(matfp,0);
+  BINWriteUInt32(matfp,0);
+  BINWriteDouble(matfp,u);
+}
+
+
+/**********************************************************/
+/*      Append Decay Matrix of One Nuclide                */
+/**********************************************************/
+void OUTMatrixWrite(DecayMatrix *dm)
+{
+  int n = dm->nlevel;
+  int m = dm->ngamma;
+  int pad = ((n + 1 + m) % 2 == 1) ? 1 : 0;
+
+  uint64_t len = 24 + 8*n + 8*n + 4*n + 4*n + 4*(n + 1 + m + pad) + 8*m + 8*m;
+
+  BINWriteUInt32(matfp,dm->z * 1000 + dm->a);
+  BINWriteUInt32(matfp,n);
+  BINWriteUInt32(matfp,m);
+  BINWriteUInt32(matfp,0);
+  BINWriteUInt64(matfp,len);
+
+  for(int i=0 ; i<n ; i++) BINWriteDouble(matfp,dm->energy[i]);
+  for(int i=0 ; i<n ; i++) BINWriteDouble(matfp,dm->thalf[i]);
+  for(int i=0 ; i<n ; i++) BINWriteInt32(matfp,dm->spin2[i]);
+  for(int i=0 ; i<n ; i++) BINWriteInt32(matfp,dm->parity[i]);
+  for(int i=0 ; i<=n ; i++) BINWriteUInt32(matfp,dm->offset[i]);
+  for(int k=0 ; k<m ; k++) BINWriteUInt32(matfp,dm->fstate[k]);
+  if(pad) BINWriteUInt32(matfp,0);
+  for(int k=0 ; k<m ; k++) BINWriteDouble(matfp,dm->photon[k]);
+  for(int k=0 ; k<m ; k++) BINWriteDouble(matfp,dm->branch[k]);
+
+  nmatrix++;
+}
+
+
+/**********************************************************/
+/*      Close Decay Matrix File                           */
+/**********************************************************/
+void OUTMatrixClose()
+{
+  matfp.seekp(8);
+  BINWriteUInt32(matfp,nmatrix);
+  matfp.close();
+
+  message << "decay matrix file " << matname << " " << nmatrix << " nuclides";
+  Notice("OUTMatrixClose");
+}
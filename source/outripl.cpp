@@ -23,13 +23,21 @@ void OUTFripl(const int nc, const int nm, ENSDF *lib)
   int nog  = 0;
   for(int i = 0 ; i < lib->getNlevel() ; i++) nog += lib->gamma[i].getNgamma();
 
-  /* calculate separation energies */
-  bool f1, f2;
-  double sn = mass_excess(lib->getZ(),lib->getA()-1,&f2) + ENEUTRON
-            - mass_excess(lib->getZ(),lib->getA()  ,&f1);
+  /* separation energies in ENSDF Q record */
+  double sn = lib->qval[QValueSn];
+  double sp = lib->qval[QValueSp];
 
-  double sp = mass_excess(lib->getZ()-1,lib->getA(),&f2) + EPROTON
-            - mass_excess(lib->getZ()  ,lib->getA(),&f1);
+  /* calculate them from mass table if not given */
+  bool f1, f2;
+  double u = 1e+6 / lib->getUnit();
+  if(!lib->qgiven[QValueSn]){
+    sn = ( mass_excess(lib->getZ(),lib->getA()-1,&f2) + ENEUTRON
+         - mass_excess(lib->getZ(),lib->getA()  ,&f1) ) * u;
+  }
+  if(!lib->qgiven[QValueSp]){
+    sp = ( mass_excess(lib->getZ()-1,lib->getA(),&f2) + EPROTON
+         - mass_excess(lib->getZ()  ,lib->getA(),&f1) ) * u;
+  }
 
   /* print header line */
   cout << setw(3) << lib->getA() << left << setw(2) << element_name[lib->getZ()];
@@ -73,6 +73,31 @@ void OUTFxml(ENSDF *lib)
       XMLTagVal("GammaEnergy",lib->gamma[i].getEnergy(j));
       XMLTagVal("GammaBranch",lib->gamma[i].getBranch(j));
       XMLTagVal("GammaConversionCoefficient",lib->gamma[i].getCvcoef(j));
+      XMLTagVal("GammaEnergyUncertainty",lib->gamma[i].getDenergy(j));
+      XMLTagVal("GammaBranchUncertainty",lib->gamma[i].getDbranch(j));
+      XMLTagVal("GammaConversionCoefficientUncertainty",lib->gamma[i].getDcvcoef(j));
+
+      /* origin of data, only when not given in ENSDF as it is */
+      switch(lib->gamma[i].getFlag(j)){
+      case GammaFilled:    XMLTagVal("GammaOrigin","filled");    break;
+      case GammaEstimated: XMLTagVal("GammaOrigin","estimated"); break;
+      case GammaMerged:    XMLTagVal("GammaOrigin","merged");    break;
+      case GammaDuplicate: XMLTagVal("GammaOrigin","duplicate"); break;
+      case GammaDoublet:   XMLTagVal("GammaOrigin","doublet");   break;
+      default:                                                   break;
+      }
+
+      /* row of branching ratio covariance within the level */
+      if(lib->gamma[i].bcov != NULL){
+        ostringstream row;
+        row.setf(ios::scientific, ios::floatfield);
+        row << setprecision(6);
+        for(int k=0 ; k<lib->gamma[i].getNgamma() ; k++){
+          if(k > 0) row << " ";
+          row << lib->gamma[i].getCovariance(j,k);
+        }
+        XMLTagVal("GammaBranchCovariance",row.str());
+      }
       XMLTagClose("GAMMA");
     }
     XMLTagClose("LEVEL");
@@ -0,0 +1,362 @@
+/******************************************************************************/
+/*  riplindex.cpp                                                             */
+/*        index of nuclide locations in RIPL zZZZ.dat files                   */
+/******************************************************************************/
+
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+using namespace std;
+
+#include "cens.h"
+#include "terminate.h"
+#include "datafile.h"
+
+static const char   RIndexMagic[] = "CENSRIX1";
+static const string RIndexFile    = "ripl.idx";
+static const int    RFileNameLength = 32;
+
+/**********************************************************/
+/*   Index Entries                                        */
+/**********************************************************/
+class RIndexFileEntry{
+ public:
+  char      name[RFileNameLength]; // zZZZ.dat file name, no directory
+  long long mtime;                 // modification time stamp
+  long long size;                  // file size in bytes
+  int       scanned;               // 1 if nuclides are in the table
+};
+
+class RIndexDataEntry{
+ public:
+  unsigned int za;                 // Z*1000 + A
+  int       file;                  // index in file table
+  long long offset;                // byte offset of header line
+  long long length;                // byte length of nuclide block
+  int       nlevel;                // number of levels
+  int       ngamma;                // number of gamma-rays
+};
+
+static void   RINDEXRefresh(string);
+static int    RINDEXReadFile(string, RIndexFileEntry **, RIndexDataEntry **, int *);
+static void   RINDEXWriteFile(string);
+static string RINDEXFileName(string);
+static int    RINDEXListFile(string, RIndexFileEntry *);
+static int    RINDEXScanFile(string, const int);
+static void   RINDEXAdd(RIndexDataEntry);
+
+static string          rindexdir = "";    // directory of the index in memory
+static bool            rindexready = false;
+static int             rnfile = 0, rndata = 0, rnsize = 0;
+static RIndexFileEntry *rftab = NULL;
+static RIndexDataEntry *rdtab = NULL;
+
+
+/***********************************************************/
+/*      Look for Nuclide in RIPL Index                     */
+/***********************************************************/
+/* each zZZZ.dat file is scanned when it is requested first, and the
+   index is saved in the directory for next runs */
+bool RIPLIndexLookup(string ripldir, ZAnumber za, string *file, RIPLBlock *rb)
+{
+  if(!rindexready || (ripldir != rindexdir)) RINDEXRefresh(ripldir);
+
+  ostringstream os;
+  os << "z" << setw(3) << setfill('0') << za.getZ() << ".dat";
+  string base = os.str();
+
+  /* zZZZ.dat, or compressed one if not found */
+  int k = -1;
+  for(int i=0 ; i<rnfile ; i++){
+    if(strcmp(rftab[i].name,base.c_str()) == 0){
+      k = i;
+      break;
+    }
+    if((k < 0) && (strncmp(rftab[i].name,base.c_str(),base.length()) == 0)) k = i;
+  }
+  if(k < 0){
+    *file = "";
+    return false;
+  }
+
+  *file = ripldir + '/' + rftab[k].name;
+
+  if(!rftab[k].scanned){
+    int n = RINDEXScanFile(*file,k);
+    rftab[k].scanned = 1;
+
+    message << "RIPL index updated, " << rftab[k].name << " " << n << " nuclides";
+    Notice("RIPLIndexLookup");
+    RINDEXWriteFile(RINDEXFileName(ripldir));
+  }
+
+  unsigned int key = za.getZ()*1000 + za.getA();
+  for(int i=0 ; i<rndata ; i++){
+    if((rdtab[i].file != k) || (rdtab[i].za != key)) continue;
+    rb->za.setZA(za.getZ(),za.getA());
+    rb->offset = rdtab[i].offset;
+    rb->length = rdtab[i].length;
+    rb->nlevel = rdtab[i].nlevel;
+    rb->ngamma = rdtab[i].ngamma;
+    return true;
+  }
+
+  return false;
+}
+
+
+/***********************************************************/
+/*      Files in Directory, Saved Entries Kept If Unchanged*/
+/***********************************************************/
+void RINDEXRefresh(string dir)
+{
+  RIndexFileEntry *ftab0 = NULL;
+  RIndexDataEntry *dtab0 = NULL;
+  int nfile0 = 0, ndata0 = 0;
+
+  rindexdir = dir;
+  rindexready = true;
+  if(rftab != NULL){ delete [] rftab; rftab = NULL; }
+  if(rdtab != NULL){ delete [] rdtab; rdtab = NULL; }
+  rnfile = rndata = rnsize = 0;
+
+  nfile0 = RINDEXReadFile(RINDEXFileName(dir),&ftab0,&dtab0,&ndata0);
+
+  int nf = RINDEXListFile(dir,NULL);
+  if(nf > 0){
+    rftab = new RIndexFileEntry [nf];
+    rnfile = RINDEXListFile(dir,rftab);
+  }
+
+  /* entries of the same file, time stamp, and size are taken */
+  for(int i=0 ; i<rnfile ; i++){
+    for(int k=0 ; k<nfile0 ; k++){
+      if( (strcmp(rftab[i].name,ftab0[k].name) != 0) || (rftab[i].mtime != ftab0[k].mtime) || (rftab[i].size != ftab0[k].size) ) continue;
+      for(int j=0 ; j<ndata0 ; j++){
+        if(dtab0[j].file != k) continue;
+        RIndexDataEntry d = dtab0[j];
+        d.file = i;
+        RINDEXAdd(d);
+      }
+      rftab[i].scanned = 1;
+      break;
+    }
+  }
+
+  if(ftab0 != NULL) delete [] ftab0;
+  if(dtab0 != NULL) delete [] dtab0;
+}
+
+
+/***********************************************************/
+/*      Index File in Directory, or Next to Tar Archive    */
+/***********************************************************/
+string RINDEXFileName(string dir)
+{
+  string arc, mem;
+  if(TARPathSplit(dir,&arc,&mem) && (mem.length() == 0)) return arc + "." + RIndexFile;
+
+  return dir + '/' + RIndexFile;
+}
+
+
+/***********************************************************/
+/*      Read Index File                                    */
+/***********************************************************/
+int RINDEXReadFile(string file, RIndexFileEntry **ft, RIndexDataEntry **dt, int *nd)
+{
+  FILE *fp = fopen(&file[0],"rb");
+  if(fp == NULL) return 0;
+
+  char magic[8];
+  int  n[4];
+  bool ok = (fread(magic,1,8,fp) == 8) && (memcmp(magic,RIndexMagic,8) == 0)
+         && (fread(n,sizeof(int),4,fp) == 4)
+         && (n[2] == (int)sizeof(RIndexFileEntry)) && (n[3] == (int)sizeof(RIndexDataEntry));
+
+  int nf = 0;
+  if(ok){
+    nf  = n[0];
+    *nd = n[1];
+    *ft = new RIndexFileEntry [nf];
+    *dt = new RIndexDataEntry [*nd];
+    ok = ((int)fread(*ft,sizeof(RIndexFileEntry),nf,fp) == nf)
+      && ((int)fread(*dt,sizeof(RIndexDataEntry),*nd,fp) == *nd);
+    if(!ok){
+      delete [] *ft; *ft = NULL;
+      delete [] *dt; *dt = NULL;
+      nf = *nd = 0;
+    }
+  }
+  fclose(fp);
+
+  if(!ok){
+    message << "RIPL index file " << file << " broken, rebuilt";
+    Notice("RIPLIndexLookup");
+  }
+
+  return nf;
+}
+
+
+/***********************************************************/
+/*      Write Index File, Scanned Files Only               */
+/***********************************************************/
+void RINDEXWriteFile(string file)
+{
+  string tmp = file + ".tmp";
+
+  /* the directory may be read-only, then index is kept in memory only */
+  FILE *fp = fopen(&tmp[0],"wb");
+  if(fp == NULL){
+    message << "RIPL index file " << file << " cannot be written";
+    Notice("RIPLIndexLookup");
+    return;
+  }
+
+  int nf = 0;
+  for(int i=0 ; i<rnfile ; i++) if(rftab[i].scanned) nf++;
+
+  int n[4] = {nf, rndata, (int)sizeof(RIndexFileEntry), (int)sizeof(RIndexDataEntry)};
+  fwrite(RIndexMagic,1,8,fp);
+  fwrite(n,sizeof(int),4,fp);
+
+  /* file numbers in the saved table */
+  int *k = new int [rnfile];
+  nf = 0;
+  for(int i=0 ; i<rnfile ; i++){
+    k[i] = -1;
+    if(!rftab[i].scanned) continue;
+    fwrite(&rftab[i],sizeof(RIndexFileEntry),1,fp);
+    k[i] = nf++;
+  }
+  for(int j=0 ; j<rndata ; j++){
+    RIndexDataEntry d = rdtab[j];
+    d.file = k[d.file];
+    fwrite(&d,sizeof(RIndexDataEntry),1,fp);
+  }
+  fclose(fp);
+  delete [] k;
+
+  rename(&tmp[0],&file[0]);
+}
+
+
+/***********************************************************/
+/*      RIPL Files zZZZ.dat in Directory                   */
+/***********************************************************/
+int RINDEXListFile(string dir, RIndexFileEntry *ft)
+{
+  int nf = DATADirectoryList(dir,NULL,NULL,NULL);
+  if(nf == 0) return 0;
+
+  string    *name  = new string [nf];
+  long long *mtime = new long long [nf];
+  long long *size  = new long long [nf];
+  nf = DATADirectoryList(dir,name,mtime,size);
+
+  int n = 0;
+  for(int i=0 ; i<nf ; i++){
+    /* zZZZ.dat, zZZZ.dat.gz, or zZZZ.dat.xz */
+    const char *d = name[i].c_str();
+    if((strlen(d) < 8) || (d[0] != 'z') || (strncmp(&d[4],".dat",4) != 0)) continue;
+    if(!isdigit(d[1]) || !isdigit(d[2]) || !isdigit(d[3])) continue;
+    if((strlen(d) != 8) && (strcmp(&d[8],".gz") != 0) && (strcmp(&d[8],".xz") != 0)) continue;
+
+    if(ft != NULL){
+      memset(&ft[n],0,sizeof(RIndexFileEntry));
+      strcpy(ft[n].name,d);
+      ft[n].mtime = mtime[i];
+      ft[n].size  = size[i];
+      ft[n].scanned = 0;
+    }
+    n++;
+  }
+
+  delete [] name;
+  delete [] mtime;
+  delete [] size;
+
+  return n;
+}
+
+
+/***********************************************************/
+/*      Scan Nuclide Blocks in RIPL File                   */
+/***********************************************************/
+/* only the numbers of levels and gamma-rays are decoded, and the
+   level and gamma-ray lines are skipped. Offsets are given in the
+   decompressed data for compressed files. The file is read once, and
+   the nuclides are added to the table directly */
+int RINDEXScanFile(string file, const int k)
+{
+  string buf;
+  if(!DATAFileRead(file,&buf)) return 0;
+
+  const char *s = buf.c_str();
+  long len = buf.length();
+  long pos = 0;
+  int  n = 0;
+
+  while(pos < len){
+    /* header line */
+    long p0 = pos;
+    const char *e = (const char *)memchr(s + pos,'\n',len - pos);
+    long p1 = (e == NULL) ? len : (e - s) + 1;
+    string h(s + p0,p1 - p0);
+    pos = p1;
+    if(h.length() < 25) continue;
+
+    int a    = atoi(h.substr( 5,5).c_str());
+    int z    = atoi(h.substr(10,5).c_str());
+    int nlev = atoi(h.substr(15,5).c_str());
+    int ngam = 0;
+
+    /* levels followed by their gamma-ray lines */
+    for(int i=0 ; (i<nlev) && (pos < len) ; i++){
+      e = (const char *)memchr(s + pos,'\n',len - pos);
+      p1 = (e == NULL) ? len : (e - s) + 1;
+      int m = (p1 - pos > 37) ? atoi(string(s + pos + 34,3).c_str()) : 0;
+      pos = p1;
+
+      for(int j=0 ; (j<m) && (pos < len) ; j++){
+        e = (const char *)memchr(s + pos,'\n',len - pos);
+        pos = (e == NULL) ? len : (e - s) + 1;
+      }
+      ngam += m;
+    }
+
+    RIndexDataEntry d;
+    d.za     = z*1000 + a;
+    d.file   = k;
+    d.offset = p0;
+    d.length = pos - p0;
+    d.nlevel = nlev;
+    d.ngamma = ngam;
+    RINDEXAdd(d);
+    n++;
+  }
+
+  return n;
+}
+
+
+/***********************************************************/
+/*      Add Entry to Table, Capacity Doubled               */
+/***********************************************************/
+void RINDEXAdd(RIndexDataEntry d)
+{
+  if(rndata >= rnsize){
+    int n = (rnsize == 0) ? 256 : rnsize * 2;
+    RIndexDataEntry *t = new RIndexDataEntry [n];
+    for(int i=0 ; i<rndata ; i++) t[i] = rdtab[i];
+    if(rdtab != NULL) delete [] rdtab;
+    rdtab = t;
+    rnsize = n;
+  }
+  rdtab[rndata++] = d;
+}
@@ -3,14 +3,28 @@
 /*        read internal conversion from RIPL data file                        */
 /******************************************************************************/
 
-#include <fstream>
 #include <iostream>
-#include <iomanip>
+#include <sstream>
+#include <cmath>
+#include <unordered_map>
 
 using namespace std;
 
 #include "cens.h"
 #include "terminate.h"
+#include "datafile.h"
+
+/* bucket of energy in units of matching tolerance */
+static inline long long RIPLQuantize(const double e, const double eps)
+{
+  return (long long)floor(e / eps);
+}
+
+/* key of initial and final buckets */
+static inline unsigned long long RIPLKey(const long long q0, const long long q1)
+{
+  return ((unsigned long long)q0 << 32) ^ (unsigned long long)(q1 & 0xffffffffLL);
+}
 
 
 /***********************************************************/
@@ -19,119 +33,132 @@ using namespace std;
 int RIPLRead(string ripldir, ENSDF *lib)
 {
   const double  eps = 1e-5;
-  ostringstream os;
-  ifstream      fp;
   string        file, str;
 
-  os << setw(3) << setfill('0') << lib->getZ();
-  file = os.str();
-  file = "z" + file + ".dat";
+  /* remove if dir name includes a slash at the end */
+  if((ripldir.length() > 1) && (ripldir[ripldir.length() - 1] == '/')) ripldir.erase(ripldir.length() - 1);
 
-  if(ripldir.length() > 0){
-    /* remove if dir name includes a slash at the end */
-    if(ripldir[ripldir.length() - 1] == '/') ripldir[ripldir.length() - 1] = '\0';
-    file = ripldir + '/' + file;
+  /* location of the nuclide in zZZZ.dat, only the block is read */
+  RIPLBlock rb;
+  string    block;
+  if(!RIPLIndexLookup(ripldir,lib->getZA(),&file,&rb)){
+    if(file.length() == 0){
+      message << "RIPL file for Z = " << lib->getZ() << " not found in " << ripldir;
+      TerminateCode("RIPLRead");
+    }
+    message << "Z = " << lib->getZ() << " A = " << lib->getA() << " not found in " << file;
+    Notice("RIPLRead");
+    return 0;
   }
 
   message << "RIPL file name " << file;
   Notice("RIPLRead");
 
-  fp.open(&file[0]);
-  if(!fp){
-    message << "RIPL file " << file << " cannot open";
+  if(!DATAFileReadRange(file,rb.offset,rb.length,&block)){
+    message << "RIPL file " << file << " cannot read";
     TerminateCode("RIPLRead");
   }
+  istringstream fp(block);
 
-  double *ex, **ic;
-  int *nl, **fs;
-  ex = new double [lib->getNsize()];
-  ic = new double * [lib->getNsize()];
-  nl = new int [lib->getNsize()];
-  fs = new int * [lib->getNsize()];
-  for(int i=0 ; i<lib->getNsize() ; i++){
-    ic[i] = new double [lib->gamma[0].getNsize()];
-    fs[i] = new int [lib->gamma[0].getNsize()];
-  }
+  /* levels and gamma-rays in CSR form, sized by the index */
+  int nlev = rb.nlevel;
+  int ngam = rb.ngamma;
+  double *ex = new double [nlev];
+  int    *go = new int [nlev + 1];   // offset of gamma-rays of each level
+  int    *fs = new int [(ngam > 0) ? ngam : 1];
+  double *ic = new double [(ngam > 0) ? ngam : 1];
 
-  bool found = false;
+  /* header line of the nuclide */
   string d;
-  int nlev = 0;
-  while(getline(fp,str)){
+  getline(fp,str);
 
-    /*** search for Z and A entry in the file */
-    d = str.substr( 5, 5);  int a   = atoi(&d[0]);
-    d = str.substr(10, 5);  int z   = atoi(&d[0]);
-    d = str.substr(15, 5);  nlev    = atoi(&d[0]);
+  /* for all discrete levels */
+  int k = 0;
+  for(int i1=0 ; i1<nlev ; i1++){
+    getline(fp,str);
+    d = str.substr( 4,10);  double e = atof(&d[0]);
+    d = str.substr(34, 3);  int    n = atoi(&d[0]);
 
-    if((z == lib->getZ()) && a == lib->getA()) found = true;
+    ex[i1] = e;
+    go[i1] = k;
 
-    /* for all discrete levels */
-    for(int i1=0 ; i1<nlev ; i1++){
+    /* for gamma-rays */
+    for(int j1=0 ; j1<n ; j1++){
       getline(fp,str);
-      d = str.substr( 4,10);  double e = atof(&d[0]);
-      d = str.substr(34, 3);  int    n = atoi(&d[0]);
-
-      if(found){
-        ex[i1] = e;
-        nl[i1] = n;
-      }
+      d = str.substr(39, 4);  int    m = atoi(&d[0]);
+      d = str.substr(77,10);  double c = atof(&d[0]);
 
-      /* for gamma-rays */
-      for(int j1=0 ; j1<n ; j1++){
-        getline(fp,str);
-        d = str.substr(39, 4);  int    m = atoi(&d[0]);
-        d = str.substr(77,10);  double c = atof(&d[0]);
-
-        if(found){
-          fs[i1][j1] = m - 1;
-          ic[i1][j1] = c;
-        }
+      fs[k] = m - 1;
+      ic[k] = c;
+      k++;
+    }
+  }
+  go[nlev] = k;
+
+  /* RIPL transitions hashed by quantized initial and final energies,
+     chained in ascending order of CSR index */
+  unordered_map<unsigned long long,int> head;
+  int *next = new int [(ngam > 0) ? ngam : 1];
+  for(int i1 = nlev-1 ; i1 >= 1 ; i1--){
+    for(int j1 = go[i1+1]-1 ; j1 >= go[i1] ; j1--){
+      next[j1] = -1;
+      if((fs[j1] < 0) || (fs[j1] >= nlev)) continue;
+      unsigned long long key = RIPLKey(RIPLQuantize(ex[i1],eps),RIPLQuantize(ex[fs[j1]],eps));
+      unordered_map<unsigned long long,int>::iterator it = head.find(key);
+      if(it != head.end()){
+        next[j1] = it->second;
+        it->second = j1;
       }
+      else head.emplace(key,j1);
     }
-    if(found) break;
   }
-  fp.close();
+
+  /* initial level of each RIPL transition */
+  int *lv = new int [(ngam > 0) ? ngam : 1];
+  for(int i1 = 0 ; i1 < nlev ; i1++){
+    for(int j1 = go[i1] ; j1 < go[i1+1] ; j1++) lv[j1] = i1;
+  }
 
   /* initial and final energies for gamma transition in ENSDF */
   for(int i0 = 1 ; i0<lib->getNlevel() ; i0++){
     double e00 = lib->getEnergy(i0);
+    long long q0 = RIPLQuantize(e00,eps);
     for(int j0=0 ; j0<lib->gamma[i0].getNgamma() ; j0++){
       double e01 = lib->getEnergy( lib->gamma[i0].getFstate(j0) );
 
       /* see if IC is zero in ENSDF */
       if(lib->gamma[i0].getCvcoef(j0) == 0.0){
 
-        bool found = false;
-        /* look for the same gamma transition in RIPL */
-        for(int i1 = 1 ; i1 < nlev ; i1++){
-          double e10 = ex[i1];
-          for(int j1 = 0 ; j1 < nl[i1] ; j1++){
-            double e11 = ex[ fs[i1][j1] ];
-
-            /* if two energies are close enough, this is it */
-            double d0 = abs(e00 - e10);
-            double d1 = abs(e01 - e11);
-            if( (d0 <= eps) && (d1 <= eps) ){
-              if(ic[i1][j1] > 0.0) lib->gamma[i0].cvcoef[j0] = ic[i1][j1];
-              found = true;
-              break;
+        /* the same gamma transition in RIPL, energies within eps are
+           in the neighbor buckets, and the first one in RIPL is taken */
+        long long q1 = RIPLQuantize(e01,eps);
+        int m = -1;
+        for(int a = -1 ; a <= 1 ; a++){
+          for(int b = -1 ; b <= 1 ; b++){
+            unordered_map<unsigned long long,int>::iterator it = head.find(RIPLKey(q0 + a,q1 + b));
+            if(it == head.end()) continue;
+            for(int j1 = it->second ; j1 >= 0 ; j1 = next[j1]){
+              if((m >= 0) && (j1 > m)) break;
+              double d0 = abs(e00 - ex[lv[j1]]);
+              double d1 = abs(e01 - ex[fs[j1]]);
+              if( (d0 <= eps) && (d1 <= eps) ){
+                m = j1;
+                break;
+              }
             }
           }
-          if(found) break;
         }
+        if((m >= 0) && (ic[m] > 0.0)) lib->gamma[i0].cvcoef[j0] = ic[m];
       }
     }
   }
 
-  for(int i=0 ; i<lib->getNsize() ; i++){
-    delete [] ic[i];
-    delete [] fs[i];
-  }
-
+  delete [] next;
+  delete [] lv;
   delete [] ex;
-  delete [] ic;
+  delete [] go;
   delete [] fs;
-  delete [] nl;
+  delete [] ic;
 
   return 0;
 }
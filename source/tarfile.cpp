@@ -0,0 +1,425 @@
+/******************************************************************************/
+/*  tarfile.cpp                                                               */
+/*        read members of tar archive without extraction                      */
+/******************************************************************************/
+
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+using namespace std;
+
+#include "datafile.h"
+#include "terminate.h"
+
+static const int TarBlockSize  = 512;   // tar header and data padding
+static const int TarArchiveMax = 8;     // number of archives kept open
+
+/**********************************************************/
+/*   Member and Archive                                   */
+/**********************************************************/
+class TarMember{
+ public:
+  string    name;                 // path name in archive
+  string    base;                 // name without directory
+  long      offset;               // byte offset of data in archive
+  long      size;                 // data length
+};
+
+class TarArchive{
+ public:
+  string     file;                // archive file name
+  char      *map;                 // mapped archive, NULL if compressed
+  long       mapsize;             // length of mapped region
+  DataStream stream;              // compressed archive, read forward only
+  long       spos;                // current position of stream
+  bool       sopen;               // stream is open
+  int        nsize;               // allocated size of member table
+  int        nmember;             // number of regular file members
+  TarMember *member;              // member table sorted by base name
+};
+
+static TarArchive *TARArchiveOpen(string);
+static void        TARArchiveScan(TarArchive *);
+static void        TARMemberAdd(TarArchive *, string, const long, const long);
+static int         TARMemberFind(TarArchive *, string);
+static long        TAROctal(const char *, const int);
+static bool        TARChecksum(const unsigned char *);
+static bool        TARExtension(string);
+static bool        TARMemberCompare(const TarMember &, const TarMember &);
+
+static TarArchive *archive[TarArchiveMax];
+static int         narchive = 0;
+
+
+/***********************************************************/
+/*      Split Path into Archive and Member Names           */
+/***********************************************************/
+/* archive.tar/dir/file is read as member dir/file of archive.tar,
+   also for archive.tar.gz, archive.tgz, archive.tar.xz, and archive.txz */
+bool TARPathSplit(string path, string *arc, string *mem)
+{
+  size_t p = 0;
+  while(p != string::npos){
+    p = path.find('/',p + 1);
+    string a = path.substr(0,p);
+    if(!TARExtension(a)) continue;
+
+    struct stat st;
+    if((stat(&a[0],&st) != 0) || !S_ISREG(st.st_mode)) continue;
+
+    *arc = a;
+    *mem = (p == string::npos) ? "" : path.substr(p + 1);
+    return true;
+  }
+
+  return false;
+}
+
+
+/***********************************************************/
+/*      Size of Member, -1 If Not Found                    */
+/***********************************************************/
+long TARMemberSize(string arc, string mem)
+{
+  TarArchive *t = TARArchiveOpen(arc);
+  int k = TARMemberFind(t,mem);
+  return (k < 0) ? -1 : t->member[k].size;
+}
+
+
+/***********************************************************/
+/*      Pointer to Mapped Member, NULL If Compressed       */
+/***********************************************************/
+const char *TARMemberMap(string arc, string mem, long *size)
+{
+  TarArchive *t = TARArchiveOpen(arc);
+  int k = TARMemberFind(t,mem);
+  if((k < 0) || (t->map == NULL)) return NULL;
+
+  *size = t->member[k].size;
+  return t->map + t->member[k].offset;
+}
+
+
+/***********************************************************/
+/*      Read Part of Member                                */
+/***********************************************************/
+bool TARMemberRead(string arc, string mem, const long offset, const long length, string *buf)
+{
+  TarArchive *t = TARArchiveOpen(arc);
+  int k = TARMemberFind(t,mem);
+  if(k < 0) return false;
+  if((offset < 0) || (offset + length > t->member[k].size)) return false;
+
+  long p = t->member[k].offset + offset;
+
+  /* uncompressed, copy from mapped archive */
+  if(t->map != NULL){
+    buf->assign(t->map + p,length);
+    return true;
+  }
+
+  /* compressed, members requested in order are read in one pass,
+     the stream is reopened only when going backward */
+  if(!t->sopen || (p < t->spos)){
+    if(!t->stream.open(t->file)) return false;
+    t->sopen = true;
+    t->spos  = 0;
+  }
+  if(!t->stream.skip(p - t->spos)){
+    t->sopen = false;
+    return false;
+  }
+
+  buf->resize(length);
+  long n = (length > 0) ? t->stream.read(&(*buf)[0],length) : 0;
+  t->spos = p + n;
+
+  return (n == length);
+}
+
+
+/***********************************************************/
+/*      List Regular File Members                          */
+/***********************************************************/
+int TARMemberList(string arc, string *name, long *size)
+{
+  TarArchive *t = TARArchiveOpen(arc);
+
+  if(name != NULL){
+    for(int i=0 ; i<t->nmember ; i++){
+      name[i] = t->member[i].base;
+      size[i] = t->member[i].size;
+    }
+  }
+
+  return t->nmember;
+}
+
+
+/***********************************************************/
+/*      Open Archive and Build Member Index, Once Per Run  */
+/***********************************************************/
+TarArchive *TARArchiveOpen(string file)
+{
+  for(int i=0 ; i<narchive ; i++){
+    if(archive[i]->file == file) return archive[i];
+  }
+
+  if(narchive == TarArchiveMax){
+    message << "too many tar archives opened, " << file;
+    TerminateCode("TARArchiveOpen");
+  }
+
+  TarArchive *t = new TarArchive;
+  t->file    = file;
+  t->map     = NULL;
+  t->mapsize = 0;
+  t->spos    = 0;
+  t->sopen   = false;
+  t->nsize   = 0;
+  t->nmember = 0;
+  t->member  = NULL;
+
+  if(!t->stream.open(file)){
+    message << "tar archive " << file << " cannot open";
+    TerminateCode("TARArchiveOpen");
+  }
+
+  /* uncompressed archive is mapped to memory */
+  if(t->stream.getFormat() == DataFormatPlain){
+    t->stream.close();
+    int fd = ::open(&file[0],O_RDONLY);
+    struct stat st;
+    if((fd >= 0) && (fstat(fd,&st) == 0) && (st.st_size > 0)){
+      void *p = mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+      if(p != MAP_FAILED){
+        t->map     = (char *)p;
+        t->mapsize = st.st_size;
+        madvise(p,st.st_size,MADV_SEQUENTIAL);
+      }
+    }
+    if(fd >= 0) ::close(fd);
+    if(t->map == NULL){
+      message << "tar archive " << file << " cannot be mapped";
+      TerminateCode("TARArchiveOpen");
+    }
+  }
+  else t->sopen = true;
+
+  TARArchiveScan(t);
+  sort(t->member,t->member + t->nmember,TARMemberCompare);
+
+  archive[narchive++] = t;
+
+  message << "tar archive " << file << " " << t->nmember << " members";
+  Notice("TARArchiveOpen");
+
+  return t;
+}
+
+
+/***********************************************************/
+/*      Walk Through Headers                               */
+/***********************************************************/
+void TARArchiveScan(TarArchive *t)
+{
+  unsigned char hbuf[TarBlockSize];
+  string longname = "";
+  long   pos = 0;
+
+  while(true){
+    /* header block */
+    const unsigned char *h = NULL;
+    if(t->map != NULL){
+      if(pos + TarBlockSize > t->mapsize) break;
+      h = (const unsigned char *)t->map + pos;
+    }
+    else{
+      if(t->stream.read((char *)hbuf,TarBlockSize) != TarBlockSize) break;
+      h = hbuf;
+    }
+    pos += TarBlockSize;
+
+    /* end of archive marked by zero block */
+    if(h[0] == '\0') break;
+    if(!TARChecksum(h)){
+      message << "tar archive " << t->file << " broken at " << pos - TarBlockSize;
+      TerminateCode("TARArchiveOpen");
+    }
+
+    long size = TAROctal((const char *)&h[124],12);
+    long next = pos + (size + TarBlockSize - 1) / TarBlockSize * TarBlockSize;
+    char type = h[156];
+    if((t->map != NULL) && (next > t->mapsize) && (size > 0)){
+      message << "tar archive " << t->file << " truncated";
+      TerminateCode("TARArchiveOpen");
+    }
+
+    /* GNU long name, or pax extended header, for the next member */
+    if((type == 'L') || (type == 'x')){
+      string d;
+      if(t->map != NULL) d.assign(t->map + pos,size);
+      else{
+        d.resize(size);
+        if(t->stream.read(&d[0],size) != size) break;
+        if(!t->stream.skip(next - pos - size)) break;
+      }
+      if(type == 'L') longname = d.c_str();
+      else{
+        /* records "length path=value\n" */
+        size_t p = 0;
+        while(p < d.length()){
+          long   n = atol(d.c_str() + p);
+          size_t q = d.find(' ',p);
+          if((n <= 0) || (q == string::npos)) break;
+          if(d.compare(q + 1,5,"path=") == 0) longname = d.substr(q + 6,p + n - q - 7);
+          p += n;
+        }
+      }
+      pos = next;
+      continue;
+    }
+
+    /* regular file */
+    if((type == '0') || (type == '\0') || (type == '7')){
+      string name;
+      if(longname.length() > 0) name = longname;
+      else{
+        name.assign((const char *)&h[0],strnlen((const char *)&h[0],100));
+        if((memcmp(&h[257],"ustar",5) == 0) && (h[345] != '\0')){
+          name = string((const char *)&h[345],strnlen((const char *)&h[345],155)) + '/' + name;
+        }
+      }
+      while(name.compare(0,2,"./") == 0) name.erase(0,2);
+      TARMemberAdd(t,name,pos,size);
+    }
+    longname = "";
+
+    if(t->map == NULL){
+      if(!t->stream.skip(next - pos)) break;
+    }
+    pos = next;
+  }
+
+  if(t->map == NULL) t->spos = pos;
+}
+
+
+/***********************************************************/
+/*      Add Member to Table                                */
+/***********************************************************/
+void TARMemberAdd(TarArchive *t, string name, const long offset, const long size)
+{
+  if(t->nmember == t->nsize){
+    int n = (t->nsize == 0) ? 1024 : 2 * t->nsize;
+    TarMember *m = new TarMember [n];
+    for(int i=0 ; i<t->nmember ; i++) m[i] = t->member[i];
+    if(t->member != NULL) delete [] t->member;
+    t->member = m;
+    t->nsize  = n;
+  }
+
+  size_t p = name.find_last_of('/');
+  t->member[t->nmember].name   = name;
+  t->member[t->nmember].base   = (p == string::npos) ? name : name.substr(p + 1);
+  t->member[t->nmember].offset = offset;
+  t->member[t->nmember].size   = size;
+  t->nmember++;
+}
+
+
+/***********************************************************/
+/*      Find Member by Path, or by Name Without Directory  */
+/***********************************************************/
+int TARMemberFind(TarArchive *t, string mem)
+{
+  size_t p = mem.find_last_of('/');
+  string base = (p == string::npos) ? mem : mem.substr(p + 1);
+
+  /* binary search for the first entry of the same base name */
+  int i0 = 0, i1 = t->nmember;
+  while(i0 < i1){
+    int m = (i0 + i1) / 2;
+    if(t->member[m].base < base) i0 = m + 1;
+    else i1 = m;
+  }
+
+  /* exact path, then any member in subdirectory, like release/ensdf.056 */
+  int k = -1;
+  for(int i=i0 ; (i<t->nmember) && (t->member[i].base == base) ; i++){
+    const string &n = t->member[i].name;
+    if(n == mem) return i;
+    if((k < 0) && (n.length() > mem.length())
+       && (n.compare(n.length() - mem.length(),mem.length(),mem) == 0)
+       && (n[n.length() - mem.length() - 1] == '/')) k = i;
+  }
+
+  return k;
+}
+
+
+/***********************************************************/
+/*      Numeric Field, Octal or GNU Base-256               */
+/***********************************************************/
+long TAROctal(const char *p, const int n)
+{
+  long v = 0;
+
+  if((unsigned char)p[0] & 0x80){
+    v = p[0] & 0x7f;
+    for(int i=1 ; i<n ; i++) v = (v << 8) | (unsigned char)p[i];
+    return v;
+  }
+
+  int i = 0;
+  while((i < n) && (p[i] == ' ')) i++;
+  for( ; (i < n) && (p[i] >= '0') && (p[i] <= '7') ; i++) v = v * 8 + (p[i] - '0');
+
+  return v;
+}
+
+
+/***********************************************************/
+/*      Header Checksum, Check Field Taken as Blanks       */
+/***********************************************************/
+bool TARChecksum(const unsigned char *h)
+{
+  long s = 0;
+  for(int i=0 ; i<TarBlockSize ; i++) s += ((i >= 148) && (i < 156)) ? ' ' : h[i];
+
+  return (s == TAROctal((const char *)&h[148],8));
+}
+
+
+/***********************************************************/
+/*      Archive Name Extension                             */
+/***********************************************************/
+bool TARExtension(string a)
+{
+  const char *ext[] = {".tar", ".tar.gz", ".tgz", ".tar.xz", ".txz"};
+
+  for(int i=0 ; i<5 ; i++){
+    size_t n = strlen(ext[i]);
+    if((a.length() > n) && (a.compare(a.length() - n,n,ext[i]) == 0)) return true;
+  }
+
+  return false;
+}
+
+
+/***********************************************************/
+/*      Sort Order: Base Name, then Path                   */
+/***********************************************************/
+bool TARMemberCompare(const TarMember &x, const TarMember &y)
+{
+  if(x.base != y.base) return (x.base < y.base);
+  return (x.name < y.name);
+}
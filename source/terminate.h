@@ -18,4 +18,4 @@ extern ostringstream message;
 /**************************************/
 void    WarningMessage     ();
 void    Notice             (std::string);
-int     TerminateCode      (std::string);
+int     TerminateCode      (std::string) __attribute__((noreturn));